@@ -23,6 +23,7 @@
 #include "copyright.h"
 #include "interrupt.h"
 #include "system.h"
+#include "slab.h"
 
 // String definitions for debugging messages
 
@@ -30,6 +31,10 @@ static char *intLevelNames[] = { "off", "on"};
 static char *intTypeNames[] = { "timer", "disk", "console write", 
 			"console read", "network send", "network recv"};
 
+// One PendingInterrupt per Schedule call: every timer tick, every
+// console character, every disk request
+static SlabPool pendingPool("PendingInterrupt", sizeof(PendingInterrupt));
+
 //----------------------------------------------------------------------
 // PendingInterrupt::PendingInterrupt
 // 	Initialize a hardware device interrupt that is to be scheduled 
@@ -50,6 +55,24 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, int param, int time,
     type = kind;
 }
 
+//----------------------------------------------------------------------
+// PendingInterrupt::operator new, PendingInterrupt::operator delete
+// 	Pending interrupts are recycled through pendingPool.
+//----------------------------------------------------------------------
+
+void *
+PendingInterrupt::operator new(size_t size)
+{
+    ASSERT(size == sizeof(PendingInterrupt));
+    return pendingPool.Alloc();
+}
+
+void
+PendingInterrupt::operator delete(void *p)
+{
+    pendingPool.Free(p);
+}
+
 //----------------------------------------------------------------------
 // Interrupt::Interrupt
 // 	Initialize the simulation of hardware device interrupts.
@@ -74,7 +97,7 @@ Interrupt::Interrupt()
 Interrupt::~Interrupt()
 {
     while (!pending->IsEmpty())
-	delete pending->Remove();
+	delete (PendingInterrupt *)pending->Remove();	// back to its SlabPool
     delete pending;
 }
 
@@ -240,57 +263,60 @@ Interrupt::Idle()
 void
 Interrupt::Halt()
 {
-    int max_completion=0, min_completion=stats->totalTicks, total_completion=0;
-    float avg_completion, var_completion=0;
-    unsigned i;
+    int max_completion=0, min_completion=stats->totalTicks, n;
+    double avg_completion, var_completion=0;
+#ifdef USER_PROGRAM
+    int *memStats, i;
+    Thread *thread;
+#endif
 
+#ifdef USER_PROGRAM
+    kernelConsole->Flush();		// output still in the console buffer
+#endif
     printf("Machine halting!\n\n");
     stats->Print();
+    SlabPool::PrintAll();
+    stackPool->Print();
+#ifdef USER_PROGRAM
+    printf("Memory: %d frames of %d bytes\n", NumPhysPages, PageSize);
+    if (compressedPool != NULL) compressedPool->Print();
+    if (syscallStats != NULL) syscallStats->Print();
+
+    // Per-process memory usage; live processes are sampled now.  A
+    // recycled pid shows its latest process.
+    for (i=0; i<processTable->NumSlots(); i++) {
+       memStats = processTable->GetMemStats(i);
+       thread = processTable->Lookup(i);
+       if ((thread != NULL) && (thread->space != NULL))
+          thread->space->GetMemStats(memStats);
+       if (memStats[MEMSTAT_PEAK_RESIDENT] == 0) continue;	// no user program
+       printf("[pid %d] resident %d (peak %d, limit %d), shared %d, swapped %d, faults %d major %d minor, evictions %d\n",
+              i, memStats[MEMSTAT_RESIDENT], memStats[MEMSTAT_PEAK_RESIDENT],
+              memStats[MEMSTAT_LIMIT], memStats[MEMSTAT_SHARED],
+              memStats[MEMSTAT_SWAPPED], memStats[MEMSTAT_MAJOR_FAULTS],
+              memStats[MEMSTAT_MINOR_FAULTS], memStats[MEMSTAT_EVICTIONS]);
+    }
+#endif
 
     if (schedulingAlgo == NON_PREEMPTIVE_SJF) {
        printf("Error in burst estimate over average burst length: %.2f\n", ((float)stats->burstEstimateError)/stats->cpu_time);
     }
 
-    if (excludeMainThread) {
-       for (i=1; i<thread_index; i++) {
-          if (exitThreadArray[i]) {
-             ASSERT(completionTimeArray[i] != -1);
-             total_completion += completionTimeArray[i];
-             if (completionTimeArray[i] > max_completion) max_completion = completionTimeArray[i];
-             if (completionTimeArray[i] < min_completion) min_completion = completionTimeArray[i];
-          }
-       }
-
-       avg_completion = (float)total_completion/(thread_index-1);
-    
-       for (i=1; i<thread_index; i++) {
-          var_completion += ((completionTimeArray[i] - avg_completion)*(completionTimeArray[i] - avg_completion));
-       }
-
-       var_completion = var_completion/(thread_index-1);
-
-       printf("Completion time statistics for all but main thread: Max: %d, Min: %d, Avg: %.2f, Variance: %.2f\n", max_completion, min_completion, avg_completion, var_completion);
+    // Completion times are summed up by Thread::Exit as threads go,
+    // since their pids are recycled
+    n = stats->numCompletedThreads;
+    if (n > 0) {
+       max_completion = stats->maxCompletionTime;
+       min_completion = stats->minCompletionTime;
+       avg_completion = stats->totalCompletionTime/n;
+       var_completion = stats->sumSquaredCompletion/n - avg_completion*avg_completion;
+       if (var_completion < 0) var_completion = 0;	// rounding, when they are all alike
     }
-    else {
-       for (i=0; i<thread_index; i++) {
-          if (exitThreadArray[i]) {
-             ASSERT(completionTimeArray[i] != -1);
-             total_completion += completionTimeArray[i];
-             if (completionTimeArray[i] > max_completion) max_completion = completionTimeArray[i];
-             if (completionTimeArray[i] < min_completion) min_completion = completionTimeArray[i];
-          }
-       }
-
-       avg_completion = (float)total_completion/thread_index;
+    else avg_completion = 0;
 
-       for (i=1; i<thread_index; i++) {
-          var_completion += ((completionTimeArray[i] - avg_completion)*(completionTimeArray[i] - avg_completion));
-       }
-
-       var_completion = var_completion/thread_index;
-
-       printf("Completion time statistics for all threads: Max: %d, Min: %d, Avg: %.2f, Variance: %.2f\n", max_completion, min_completion, avg_completion, var_completion);
-    }
+    printf("Completion time statistics for %s: Max: %d, Min: %d, Avg: %.2f, Variance: %.2f\n",
+           excludeMainThread ? "all but main thread" : "all threads",
+           max_completion, min_completion, avg_completion, var_completion);
 
     Cleanup();     // Never returns.
 }
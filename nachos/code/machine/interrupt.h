@@ -62,6 +62,9 @@ class PendingInterrupt {
 				// initialize an interrupt that will
 				// occur in the future
 
+    void *operator new(size_t size);	// Allocated from a SlabPool
+    void operator delete(void *p);	// (see slab.h)
+
     VoidFunctionPtr handler;    // The function (in the hardware device
 				// emulator) to call when the interrupt occurs
     int arg;                    // The argument to the function.
@@ -72,6 +72,7 @@ Machine::Machine(bool debug)
     pageTable = NULL;
 #endif
 
+    linkAddress = -1;
     singleStep = debug;
     CheckEndian();
 }
@@ -28,14 +28,20 @@
 
 // Definitions related to the size, and format of user memory
 
-#define PageSize 	SectorSize 	// set the page size equal to
-					// the disk sector size, for
-					// simplicity
+// The page size and the number of physical frames are chosen when
+// Nachos starts (-ps and -np, see Initialize), so that different memory
+// configurations can be simulated without recompiling.  Pages live in
+// host memory only, so the page size need not match the disk sector size.
 
-// #define NumPhysPages    32
-#define NumPhysPages    1024
+#define DEFAULT_PAGE_SIZE	SectorSize	// used if -ps is not given
+#define DEFAULT_NUM_PHYS_PAGES	1024		// used if -np is not given
+
+extern int PageSize;			// bytes per page; a multiple of 4,
+					// so no word straddles two pages
+extern int NumPhysPages;		// frames of main memory
 #define MemorySize 	(NumPhysPages * PageSize)
 #define TLBSize		4		// if there is a TLB, make it small
+#define LinkLineSize	16		// bytes covered by an LL reservation
 
 enum ExceptionType { NoException,           // Everything ok!
 		     SyscallException,      // A program executed a system call.
@@ -119,6 +125,20 @@ class Machine {
     void WriteRegister(int num, int value);
 				// store a value into a CPU register
 
+// Routines used by system calls to move data between the kernel and
+// user memory.  Each page is translated once, faulting it in if needed;
+// a bad user address makes them fail instead of crashing Nachos.
+
+    bool CopyFromUser(int addr, char *into, int size);
+				// Copy "size" bytes at user address "addr"
+    bool CopyToUser(int addr, char *from, int size);
+				// Copy "size" bytes to user address "addr"
+    int CopyStringFromUser(int addr, char *into, int maxSize);
+				// Copy a null-terminated string of at most
+				// maxSize bytes (null included); returns its
+				// length, maxSize if it did not end in time,
+				// or -1 on a bad address
+
 
 // Routines internal to the machine simulation -- DO NOT call these 
 
@@ -135,6 +155,11 @@ class Machine {
     
    int PageFaultHandler(unsigned int vpn);	//Page Fault Handler 
 
+    void ClearLink() { linkAddress = -1; }	// Drop the reservation made
+				// by LL; done on every context switch
+    void StoreToLink(int physAddr, int size);	// Drop the reservation if
+				// a store hits the linked line
+
 
 
    ExceptionType Translate(int virtAddr, int* physAddr, int size,bool writing);
@@ -147,6 +172,10 @@ class Machine {
     int GetPA (unsigned vaddr); // Returns the physical address corresponding
                                 // to the passed virtual address.
 
+    ExceptionType TranslateForCopy(int virtAddr, int* physAddr, bool writing);
+				// Translate, servicing page faults and
+				// copy-on-write faults on the way
+
     void RaiseException(ExceptionType which, int badVAddr);
 				// Trap to the Nachos kernel, because of a
 				// system call or other exception.  
@@ -192,6 +221,8 @@ class Machine {
     unsigned int pageTableSize;
 
   private:
+    int linkAddress;		// physical line reserved by the last LL,
+				// -1 if none; SC only succeeds while set
     bool singleStep;		// drop back into the debugger after each
 				// simulated instruction
     int runUntilTime;		// drop back into the debugger when simulated
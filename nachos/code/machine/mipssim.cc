@@ -278,6 +278,20 @@ Machine::OneInstruction(Instruction *instr)
 	nextLoadValue = value;
 	break;
     	
+      case OP_LL:			// LW that also reserves the line
+	tmp = registers[instr->rs] + instr->extra;
+	if (tmp & 0x3) {
+	    RaiseException(AddressErrorException, tmp);
+	    return;
+	}
+	if (!machine->ReadMem(tmp, 4, &value))
+	    return;
+	(void) Translate(tmp, &linkAddress, 4, FALSE);	// just read, so valid
+	linkAddress &= ~(LinkLineSize - 1);
+	nextLoadReg = instr->rt;
+	nextLoadValue = value;
+	break;
+
       case OP_LWL:	  
 	tmp = registers[instr->rs] + instr->extra;
 
@@ -475,6 +489,29 @@ Machine::OneInstruction(Instruction *instr)
 	    return;
 	break;
 	
+      case OP_SC: {			// SW, but only while the line is
+	ExceptionType exception;	// still reserved by LL; rt tells
+					// whether the store was done
+	tmp = registers[instr->rs] + instr->extra;
+	if (tmp & 0x3) {
+	    RaiseException(AddressErrorException, tmp);
+	    return;
+	}
+	exception = Translate(tmp, &value, 4, TRUE);
+	if (exception != NoException) {	// retried once it is serviced
+	    RaiseException(exception, tmp);
+	    return;
+	}
+	if ((linkAddress == -1) || ((value & ~(LinkLineSize - 1)) != linkAddress)) {
+	    registers[instr->rt] = 0;
+	    break;
+	}
+	if (!machine->WriteMem((unsigned) tmp, 4, registers[instr->rt]))
+	    return;			// (the store cleared the reservation)
+	registers[instr->rt] = 1;
+	break;
+      }
+
       case OP_SWL:	  
 	tmp = registers[instr->rs] + instr->extra;
 
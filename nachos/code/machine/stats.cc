@@ -22,6 +22,8 @@ Statistics::Statistics()
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numPagesMerged = numCowFaults = numPagesRemapped = 0;
+    faultServiceTicks = 0;
     
     total_wait_time = 0;
     cpu_time = 0;
@@ -34,6 +36,13 @@ Statistics::Statistics()
     nonpreemptive_switch = 0;
 
     burstEstimateError = 0;
+
+    numTotalThreads = 0;
+    numCompletedThreads = 0;
+    totalCompletionTime = 0;
+    sumSquaredCompletion = 0;
+    maxCompletionTime = 0;
+    minCompletionTime = 0x7fffffff;
 }
 
 //----------------------------------------------------------------------
@@ -51,6 +60,11 @@ Statistics::Print()
     printf("Console I/O: reads %d, writes %d\n", numConsoleCharsRead, 
 	numConsoleCharsWritten);
     printf("Paging: faults %d\n", numPageFaults);
+    printf("Fault service: total ticks %d, average %.2f\n", faultServiceTicks,
+	numPageFaults ? (float)faultServiceTicks/numPageFaults : 0.0);
+    printf("Page merging: frames saved %d, copy-on-write faults %d\n", 
+	numPagesMerged, numCowFaults);
+    printf("Message queues: pages remapped %d\n", numPagesRemapped);
     printf("Network I/O: packets received %d, sent %d\n", numPacketsRecvd, 
 	numPacketsSent);
 
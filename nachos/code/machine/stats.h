@@ -41,6 +41,13 @@ class Statistics {
 
     int numTotalThreads;	// Total number of created threads
 
+    int numCompletedThreads;	// Threads that called Exit (but the main
+				// thread if excludeMainThread)
+    double totalCompletionTime;	// Sum of their completion ticks, which
+				// overflows an int on long runs
+    double sumSquaredCompletion;	// Sum of the squares, for the variance
+    int maxCompletionTime, minCompletionTime;
+
     int burstEstimateError;	// Keeps track of the squared error in burst estimates
 
     int numDiskReads;		// number of disk read requests
@@ -48,6 +55,10 @@ class Statistics {
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
+    int numPagesMerged;		// number of frames freed by merging identical pages
+    int numCowFaults;		// number of writes to merged (copy-on-write) pages
+    int numPagesRemapped;	// message pages moved by remapping, not copying
+    int faultServiceTicks;	// ticks from page faults until they were serviced
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
 
@@ -407,6 +407,21 @@ Delay(int seconds)
     (void) sleep((unsigned) seconds);
 }
 
+//----------------------------------------------------------------------
+// HostMicroseconds
+// 	Return the host wall clock in microseconds.  Only differences
+//	are meaningful; the value wraps around every hour or so.
+//----------------------------------------------------------------------
+
+unsigned
+HostMicroseconds()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (unsigned)tv.tv_sec * 1000000 + (unsigned)tv.tv_usec;
+}
+
 //----------------------------------------------------------------------
 // Abort
 // 	Quit and drop core.
@@ -42,6 +42,7 @@ extern void SendToSocket(int sockID, char *buffer, int packetSize,char *toName);
 extern void Abort();
 extern void Exit(int exitCode);
 extern void Delay(int seconds);
+extern unsigned HostMicroseconds();	// Wall clock, for measurements only
 
 // Initialize system so that cleanUp routine is called when user hits ctl-C
 extern void CallOnUserAbort(VoidNoArgFunctionPtr cleanUp);
@@ -165,6 +165,7 @@ Machine::WriteMem(int addr, int size, int value)
     }
     exception = Translate(addr, &physicalAddress, size, TRUE);
   }
+    StoreToLink(physicalAddress, size);
     switch (size) {
       case 1:
 	machine->mainMemory[physicalAddress] = (unsigned char) (value & 0xff);
@@ -186,6 +187,130 @@ Machine::WriteMem(int addr, int size, int value)
     return TRUE;
 }
 
+//----------------------------------------------------------------------
+// Machine::StoreToLink
+//      Called for every store to user memory, by the program or by the
+//	kernel.  If it touches the line reserved by LL, a later SC must
+//	fail, so drop the reservation.
+//----------------------------------------------------------------------
+
+void
+Machine::StoreToLink(int physAddr, int size)
+{
+    if ((linkAddress != -1) && (physAddr < linkAddress + LinkLineSize) &&
+	(physAddr + size > linkAddress))
+	linkAddress = -1;
+}
+
+//----------------------------------------------------------------------
+// Machine::TranslateForCopy
+//      Translate "virtAddr" for a kernel copy.  Page faults and writes
+//	to copy-on-write pages are serviced and the translation retried;
+//	any other exception (a bad address) is returned to the caller.
+//
+//	We are inside a system call, so the kernel's handlers are called
+//	directly rather than through RaiseException, which would put the
+//	machine back in UserMode while the system call is still running.
+//----------------------------------------------------------------------
+
+ExceptionType
+Machine::TranslateForCopy(int virtAddr, int* physAddr, bool writing)
+{
+    ExceptionType exception = Translate(virtAddr, physAddr, 1, writing);
+
+    while ((exception == PageFaultException) || (exception == ReadOnlyException)) {
+	registers[BadVAddrReg] = virtAddr;	// where the handlers look
+	ExceptionHandler(exception);
+	exception = Translate(virtAddr, physAddr, 1, writing);
+    }
+    return exception;
+}
+
+//----------------------------------------------------------------------
+// Machine::CopyFromUser
+//      Copy "size" bytes of user memory at "addr" into "into", one
+//	contiguous span per page.  Returns FALSE if part of the range is
+//	not in the address space.
+//----------------------------------------------------------------------
+
+bool
+Machine::CopyFromUser(int addr, char *into, int size)
+{
+    int physicalAddress, span;
+
+    DEBUG('a', "Copying %d bytes from VA 0x%x\n", size, addr);
+    while (size > 0) {
+	if (TranslateForCopy(addr, &physicalAddress, FALSE) != NoException)
+	    return FALSE;
+	span = PageSize - ((unsigned) addr % PageSize);	// rest of this page
+	if (span > size) span = size;
+	bcopy(&mainMemory[physicalAddress], into, span);
+	addr += span;
+	into += span;
+	size -= span;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Machine::CopyToUser
+//      Copy "size" bytes from "from" into user memory at "addr".
+//	Merged pages get their own copy before they are written.
+//	Returns FALSE if part of the range is not in the address space.
+//----------------------------------------------------------------------
+
+bool
+Machine::CopyToUser(int addr, char *from, int size)
+{
+    int physicalAddress, span;
+
+    DEBUG('a', "Copying %d bytes to VA 0x%x\n", size, addr);
+    while (size > 0) {
+	if (TranslateForCopy(addr, &physicalAddress, TRUE) != NoException)
+	    return FALSE;
+	span = PageSize - ((unsigned) addr % PageSize);
+	if (span > size) span = size;
+	StoreToLink(physicalAddress, span);
+	bcopy(from, &mainMemory[physicalAddress], span);
+	addr += span;
+	from += span;
+	size -= span;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Machine::CopyStringFromUser
+//      Copy the null-terminated string at user address "addr" into
+//	"into", which has room for "maxSize" bytes.  Returns the length
+//	of the string, maxSize if no null was found in maxSize bytes
+//	(so the caller may continue from addr + maxSize), or -1 if the
+//	string runs off the address space.
+//----------------------------------------------------------------------
+
+int
+Machine::CopyStringFromUser(int addr, char *into, int maxSize)
+{
+    int physicalAddress, span, length = 0;
+    char *end;
+
+    while (length < maxSize) {
+	if (TranslateForCopy(addr + length, &physicalAddress, FALSE) != NoException)
+	    return -1;
+	span = PageSize - ((unsigned) (addr + length) % PageSize);
+	if (span > maxSize - length) span = maxSize - length;
+	end = (char *) memchr(&mainMemory[physicalAddress], '\0', span);
+	if (end != NULL) {
+	    span = end - &mainMemory[physicalAddress] + 1;	// include the null
+	    bcopy(&mainMemory[physicalAddress], &into[length], span);
+	    return length + span - 1;
+	}
+	bcopy(&mainMemory[physicalAddress], &into[length], span);
+	length += span;
+    }
+    return maxSize;
+}
+
 //---------------------------------------------------------------------
 //Machine::PageFaultHandler
 //Made by Group15
@@ -267,7 +392,7 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
     	entry = &pageTable[vpn];
     } else {
         for (entry = NULL, i = 0; i < TLBSize; i++)
-    	    if (tlb[i].valid && (tlb[i].virtualPage == vpn)) {
+    	    if (tlb[i].valid && ((unsigned) tlb[i].virtualPage == vpn)) {
 		entry = &tlb[i];			// FOUND!
 		break;
 	    }
@@ -292,11 +417,12 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 
     // if the pageFrame is too big, there is something really wrong! 
     // An invalid translation was loaded into the page table or TLB. 
-    if (pageFrame >= NumPhysPages) { 
+    if (pageFrame >= (unsigned) NumPhysPages) { 
 	DEBUG('a', "*** frame %d > %d!\n", pageFrame, NumPhysPages);
 	return BusErrorException;
     }
     entry->use = TRUE;		// set the use, dirty bits
+    frameLastUse[pageFrame] = stats->totalTicks;	// for LRU replacement
     if (writing)
 	entry->dirty = TRUE;
     *physAddr = pageFrame * PageSize + offset;
@@ -324,7 +450,7 @@ Machine::GetPA (unsigned vaddr)
    if ((vpn < pageTableSize) && pageTable[vpn].valid) {
       entry = &pageTable[vpn];
       pageFrame = entry->physicalPage;
-      if (pageFrame >= NumPhysPages) return -1;
+      if (pageFrame >= (unsigned) NumPhysPages) return -1;
       return pageFrame * PageSize + offset;
    }
    else return -1;
@@ -41,6 +41,9 @@ class TranslationEntry {
     bool dirty;         // This bit is set by the hardware every time the
 			// page is modified.
     bool shared;
+    bool cow;		// Set on pages whose frame was merged with another
+			// identical frame; readOnly is also set, and the
+			// first write gets a private copy back.
 };
 
 #endif
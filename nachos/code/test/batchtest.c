@@ -0,0 +1,101 @@
+/* batchtest.c
+ *	Make the same small calls one trap at a time, through an explicit
+ *	sys_Batch, and through the queued batch_Print* stubs, and compare
+ *	the time each takes.  Then check where batches stop, and that
+ *	sys_Fork does not hand the queue to the child.
+ */
+
+#include "syscall.h"
+
+#define N 40
+#define BIG 2048			/* more than the kernel's console
+					   buffer holds */
+
+BatchRecord records[N];
+char big[BIG];
+
+int
+main()
+{
+    int i, t0, t1, t2, t3, done, child, pipe[2];
+
+    t0 = sys_GetTime();
+    for (i=0; i<N; i++) {
+       sys_PrintInt(sys_GetPID());
+       sys_PrintChar(' ');
+    }
+    sys_PrintChar('\n');
+
+    t1 = sys_GetTime();
+    for (i=0; i<N; i+=2) {
+       records[i].code = syscall_GetPID;
+       records[i+1].code = syscall_PrintChar;
+       records[i+1].args[0] = '.';
+    }
+    done = sys_Batch(records, N);
+    sys_PrintChar('\n');
+
+    t2 = sys_GetTime();
+    for (i=0; i<N; i++) {
+       batch_PrintInt(i);
+       batch_PrintChar(' ');
+    }
+    batch_PrintChar('\n');
+    batch_Flush();
+    t3 = sys_GetTime();
+
+    sys_PrintString("batch completed ");
+    sys_PrintInt(done);
+    sys_PrintString(" calls, last pid ");
+    sys_PrintInt(records[N-2].result);
+    sys_PrintString("\nticks: one at a time ");
+    sys_PrintInt(t1 - t0);
+    sys_PrintString(", sys_Batch ");
+    sys_PrintInt(t2 - t1);
+    sys_PrintString(", queued ");
+    sys_PrintInt(t3 - t2);
+    sys_PrintChar('\n');
+
+    records[0].code = syscall_Time;
+    records[1].code = syscall_Sleep;		/* may not be batched */
+    records[2].code = syscall_Time;
+    sys_PrintString("stopped at ");
+    sys_PrintInt(sys_Batch(records, 3));
+    sys_PrintChar('\n');
+
+    sys_Pipe(pipe);
+    records[0].code = syscall_Time;
+    records[1].code = syscall_Write;		/* a pipe end may wait */
+    records[1].args[0] = (int)"x";
+    records[1].args[1] = 1;
+    records[1].args[2] = pipe[1];
+    sys_PrintString("stopped before pipe write at ");
+    sys_PrintInt(sys_Batch(records, 2));
+    sys_PrintChar('\n');
+    sys_Close(pipe[0]);
+    sys_Close(pipe[1]);
+
+    records[1].code = syscall_Write;		/* would wait for the console */
+    records[1].args[0] = (int)big;
+    records[1].args[1] = BIG;
+    records[1].args[2] = ConsoleOutput;
+    sys_PrintString("stopped before long console write at ");
+    sys_PrintInt(sys_Batch(records, 2));
+    sys_PrintChar('\n');
+
+    records[1].code = syscall_Create;		/* waits for the disk */
+    records[1].args[0] = (int)"batchtest.out";
+    sys_PrintString("stopped before create at ");
+    sys_PrintInt(sys_Batch(records, 2));
+    sys_PrintChar('\n');
+
+    /* sys_Fork flushes first, so the child does not print this again */
+    batch_PrintString("queued before fork, printed once\n");
+    child = sys_Fork();
+    if (child == 0) {
+       sys_PrintString("child\n");
+       return 0;
+    }
+    sys_Join(child);
+    return 0;
+}
@@ -0,0 +1,19 @@
+/* echo.c
+ *	Write the arguments to ConsoleOutput, which the shell may have
+ *	connected to a pipe:  echo hello world | upper
+ */
+
+#include "syscall.h"
+
+int
+main(int argc, char **argv)
+{
+    int i, n;
+
+    for (i = 1; i < argc; i++) {
+       for (n = 0; argv[i][n] != '\0'; n++) ;
+       sys_Write(argv[i], n, ConsoleOutput);
+       sys_Write((i < argc - 1) ? " " : "\n", 1, ConsoleOutput);
+    }
+    return 0;
+}
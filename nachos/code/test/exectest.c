@@ -0,0 +1,57 @@
+/* exectest.c
+ *	Exec this program over itself ROUNDS times, passing the round
+ *	number as an argument.  Every round checks the arguments it got.
+ *	With leaks in Exec, memory or file descriptors run out well
+ *	before the last round.
+ */
+
+#include "syscall.h"
+
+#define ROUNDS 200
+
+int
+main(int argc, char **argv)
+{
+    char number[12], *args[4];
+    int round = 0, i, n;
+
+    if (argc == 3) {
+       for (i = 0; argv[2][i] != '\0'; i++) round = 10*round + argv[2][i] - '0';
+    }
+    else if (argc != 1) {
+       sys_PrintString("Bad argc ");
+       sys_PrintInt(argc);
+       sys_PrintChar('\n');
+       return 1;
+    }
+
+    if (round == 0) {
+       if (sys_Exec("no such program", 0) != -1) {
+          sys_PrintString("Exec of a missing program did not fail\n");
+          return 1;
+       }
+    }
+    if ((round % 50) == 0) {
+       sys_PrintString("Round ");
+       sys_PrintInt(round);
+       sys_PrintChar('\n');
+    }
+    if (round == ROUNDS) {
+       sys_PrintString("All rounds done\n");
+       return 0;
+    }
+
+    round++;
+    n = 0;
+    for (i = round; i > 0; i /= 10) n++;
+    number[n] = '\0';
+    for (i = round; n > 0; i /= 10) number[--n] = '0' + (i % 10);
+
+    args[0] = argv[0];
+    args[1] = "round";
+    args[2] = number;
+    args[3] = 0;
+    sys_Exec(argv[0], args);
+    sys_PrintString("Exec failed\n");
+    return 1;
+}
@@ -0,0 +1,51 @@
+/* filetest.c
+ *	Create a file, write a few kilobytes to it, and read it back
+ *	through a second open.  Then fork: parent and child read the
+ *	same open file, so each gets a different part of it.
+ */
+
+#include "syscall.h"
+
+#define SIZE 4000
+
+char data[SIZE], back[SIZE];
+
+int
+main()
+{
+    int i, fd, n, child;
+
+    for (i=0; i<SIZE; i++) data[i] = 'a' + (i % 26);
+
+    if (sys_Create("filetest.out") < 0) {
+       sys_PrintString("Create failed\n");
+       return 1;
+    }
+    fd = sys_Open("filetest.out");
+    n = sys_Write(data, SIZE, fd);
+    sys_PrintString("Wrote ");
+    sys_PrintInt(n);
+    sys_PrintString(" bytes\n");
+    sys_Close(fd);
+
+    fd = sys_Open("filetest.out");
+    n = sys_Read(back, SIZE, fd);
+    for (i=0; i<n; i++) if (back[i] != data[i]) break;
+    sys_PrintString("Read ");
+    sys_PrintInt(n);
+    sys_PrintString(" bytes, ");
+    sys_PrintString((i == SIZE) ? "contents match\n" : "contents differ\n");
+    sys_Close(fd);
+
+    fd = sys_Open("filetest.out");
+    child = sys_Fork();
+    n = sys_Read(back, 10, fd);		/* the offset is shared */
+    back[n] = '\0';
+    if (child == 0) sys_PrintString("child read: ");
+    else sys_PrintString("parent read: ");
+    sys_Write(back, n, ConsoleOutput);
+    sys_PrintChar('\n');
+    sys_Close(fd);
+    if (child != 0) sys_Join(child);
+    return 0;
+}
@@ -0,0 +1,77 @@
+/* futextest.c
+ *	Processes sharing a counter protected by a user-level mutex, and
+ *	a producer and a consumer passing numbers through a one slot
+ *	buffer with two user-level semaphores.  The children yield inside
+ *	their critical sections to make sure the locks are contended.
+ */
+
+#include "syscall.h"
+#include "usync.h"
+
+#define NUM_CHILDREN	4
+#define NUM_INCREMENTS	50
+#define NUM_ITEMS	20
+
+typedef struct {
+   UMutex lock;
+   int counter;
+   USemaphore empty, full;
+   int slot;
+} Shared;
+
+Shared *shared;
+
+int
+main()
+{
+    int pid[NUM_CHILDREN + 1], i, j, value, sum;
+
+    shared = (Shared *)sys_ShmAllocate(sizeof(Shared));
+    umutex_Init(&shared->lock);
+    shared->counter = 0;
+    usem_Init(&shared->empty, 1);
+    usem_Init(&shared->full, 0);
+
+    for (i = 0; i < NUM_CHILDREN; i++) {
+       pid[i] = sys_Fork();
+       if (pid[i] == 0) {
+          for (j = 0; j < NUM_INCREMENTS; j++) {
+             umutex_Lock(&shared->lock);
+             value = shared->counter;
+             if ((j % 7) == 0) sys_Yield();
+             shared->counter = value + 1;
+             umutex_Unlock(&shared->lock);
+          }
+          sys_Exit(0);
+       }
+    }
+
+    pid[NUM_CHILDREN] = sys_Fork();
+    if (pid[NUM_CHILDREN] == 0) {		/* producer */
+       for (j = 1; j <= NUM_ITEMS; j++) {
+          usem_P(&shared->empty);
+          shared->slot = j;
+          usem_V(&shared->full);
+       }
+       sys_Exit(0);
+    }
+    sum = 0;					/* we are the consumer */
+    for (j = 1; j <= NUM_ITEMS; j++) {
+       usem_P(&shared->full);
+       sum += shared->slot;
+       usem_V(&shared->empty);
+    }
+
+    for (i = 0; i <= NUM_CHILDREN; i++) sys_Join(pid[i]);
+
+    sys_PrintString("Counter: ");
+    sys_PrintInt(shared->counter);
+    sys_PrintString(" (expected ");
+    sys_PrintInt(NUM_CHILDREN * NUM_INCREMENTS);
+    sys_PrintString(")\nSum of items: ");
+    sys_PrintInt(sum);
+    sys_PrintString(" (expected ");
+    sys_PrintInt(NUM_ITEMS * (NUM_ITEMS + 1) / 2);
+    sys_PrintString(")\n");
+    return 0;
+}
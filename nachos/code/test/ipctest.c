@@ -0,0 +1,42 @@
+/* ipctest.c
+ *	Create many semaphores, use and remove them, and check that an
+ *	id is no longer accepted once its semaphore has been removed,
+ *	even after the slot has been given to a new semaphore.
+ */
+
+#include "syscall.h"
+#include "synchop.h"
+
+#define NUM_SEMAPHORES	1000
+#define FIRST_KEY	5000
+
+int ids[NUM_SEMAPHORES];
+
+int
+main()
+{
+    int i, value, errors = 0, staleId, newId;
+
+    for (i = 0; i < NUM_SEMAPHORES; i++) ids[i] = sys_SemGet(FIRST_KEY + i);
+    for (i = 0; i < NUM_SEMAPHORES; i++) {
+       if (sys_SemGet(FIRST_KEY + i) != ids[i]) errors++;	/* same key, same id */
+       sys_SemOp(ids[i], -1);
+       sys_SemOp(ids[i], 1);
+       sys_SemOp(ids[i], 1);
+       if ((sys_SemCtl(ids[i], SYNCH_GET, &value) < 0) || (value != 2)) errors++;
+    }
+
+    staleId = ids[0];
+    for (i = 0; i < NUM_SEMAPHORES; i++)
+       if (sys_SemCtl(ids[i], SYNCH_REMOVE, 0) < 0) errors++;
+    newId = sys_SemGet(FIRST_KEY);
+    if (newId == staleId) errors++;
+    if (sys_SemCtl(staleId, SYNCH_GET, &value) != -1) errors++;
+    if (sys_SemCtl(newId, SYNCH_GET, &value) < 0) errors++;
+    sys_SemCtl(newId, SYNCH_REMOVE, 0);
+
+    sys_PrintString("IPC test done, errors: ");
+    sys_PrintInt(errors);
+    sys_PrintChar('\n');
+    return 0;
+}
@@ -0,0 +1,67 @@
+/* llsctest.c
+ *	Processes updating shared memory with LL/SC only: one counter
+ *	with atomic_FetchAdd, and one plain counter behind a spinlock
+ *	built on atomic_Swap.  The children yield in the middle of their
+ *	updates to make sure they interleave.
+ */
+
+#include "syscall.h"
+
+#define NUM_CHILDREN	4
+#define NUM_UPDATES	50
+
+typedef struct {
+   int atomicCounter;
+   int spinlock;
+   int lockedCounter;
+} Shared;
+
+Shared *shared;
+
+void
+SpinLock (int *lock)
+{
+   while (atomic_Swap(lock, 1) != 0) sys_Yield();
+}
+
+void
+SpinUnlock (int *lock)
+{
+   atomic_Swap(lock, 0);
+}
+
+int
+main()
+{
+    int pid[NUM_CHILDREN], i, j, value;
+
+    shared = (Shared *)sys_ShmAllocate(sizeof(Shared));
+    shared->atomicCounter = 0;
+    shared->spinlock = 0;
+    shared->lockedCounter = 0;
+
+    for (i = 0; i < NUM_CHILDREN; i++) {
+       pid[i] = sys_Fork();
+       if (pid[i] == 0) {
+          for (j = 0; j < NUM_UPDATES; j++) {
+             atomic_FetchAdd(&shared->atomicCounter, 1);
+             SpinLock(&shared->spinlock);
+             value = shared->lockedCounter;
+             if ((j % 5) == 0) sys_Yield();
+             shared->lockedCounter = value + 1;
+             SpinUnlock(&shared->spinlock);
+          }
+          sys_Exit(0);
+       }
+    }
+    for (i = 0; i < NUM_CHILDREN; i++) sys_Join(pid[i]);
+
+    sys_PrintString("Atomic counter: ");
+    sys_PrintInt(shared->atomicCounter);
+    sys_PrintString(", locked counter: ");
+    sys_PrintInt(shared->lockedCounter);
+    sys_PrintString(" (expected ");
+    sys_PrintInt(NUM_CHILDREN * NUM_UPDATES);
+    sys_PrintString(")\n");
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include "syscall.h"
+#include "memstat.h"
+#define SIZE (4*1024)
+#define LIMIT 16
+
+int array[SIZE];
+
+void
+PrintStat (char *name, int value)
+{
+    sys_PrintString(name);
+    sys_PrintInt(value);
+    sys_PrintChar('\n');
+}
+
+int
+main()
+{
+    int i, k, sum=0;
+    int counters[NUM_MEM_STATS];
+
+    if (sys_SetMemLimit(LIMIT) < 0)
+       sys_PrintString("No resident-set limit without page replacement\n");
+    for (k=0; k<2; k++)
+       for (i=0; i<SIZE; i++) { array[i] += i; sum += array[i]; }
+
+    sys_MemStat(counters);
+    PrintStat("Resident pages: ", counters[MEMSTAT_RESIDENT]);
+    PrintStat("Peak resident pages: ", counters[MEMSTAT_PEAK_RESIDENT]);
+    PrintStat("Swapped pages: ", counters[MEMSTAT_SWAPPED]);
+    PrintStat("Major faults: ", counters[MEMSTAT_MAJOR_FAULTS]);
+    PrintStat("Minor faults: ", counters[MEMSTAT_MINOR_FAULTS]);
+    PrintStat("Evictions: ", counters[MEMSTAT_EVICTIONS]);
+    PrintStat("Sum: ", sum);
+    return 0;
+}
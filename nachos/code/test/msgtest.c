@@ -0,0 +1,85 @@
+/* msgtest.c
+ *	A parent sends a child messages through a kernel message queue.
+ *	Short text messages are copied; messages of whole pages at
+ *	page-aligned addresses are remapped, which the child checks by
+ *	comparing the physical address of its buffer with the one the
+ *	parent wrote into the page.  Both sides then write to their
+ *	buffers, which must give them private copies again.
+ */
+
+#include "syscall.h"
+
+#define QUEUE_KEY	21
+#define NUM_TEXT	10
+#define NUM_BULK	6
+#define BULK_PAGES	2
+
+/* Room for BULK_PAGES pages of up to MAX_MSG_SIZE / BULK_PAGES bytes,
+ * wherever the first page boundary falls */
+char sendArea[2 * MAX_MSG_SIZE];
+char recvArea[2 * MAX_MSG_SIZE];
+
+int pageSize;
+
+char *
+PageAlign(char *p)
+{
+    return p + (pageSize - (int)p % pageSize) % pageSize;
+}
+
+int
+main()
+{
+    char text[16], *buf;
+    int queue, pid, i, j, size, bulkSize, errors = 0, remapped = 0;
+
+    pageSize = sys_PageSize();
+    bulkSize = BULK_PAGES * pageSize;
+    if (bulkSize > MAX_MSG_SIZE) {
+       sys_PrintString("Pages too large for a message\n");
+       return 1;
+    }
+    queue = sys_MsgQueueGet(QUEUE_KEY, 4);
+    pid = sys_Fork();
+    if (pid == 0) {
+       for (i = 0; i < NUM_TEXT; i++) {
+          size = sys_MsgReceive(queue, text, sizeof(text));
+          if ((size != 8) || (text[6] != 'a' + i)) errors++;
+       }
+       buf = PageAlign(recvArea);
+       if (sys_MsgReceive(queue, buf, 1) != -1) errors++;	/* too small */
+       for (i = 0; i < NUM_BULK; i++) {
+          if (sys_MsgReceive(queue, buf, bulkSize) != bulkSize) errors++;
+          for (j = sizeof(int); j < bulkSize; j++)
+             if (buf[j] != (char)(i + j)) errors++;
+          if (*(int *)buf == sys_GetPA((unsigned)buf)) remapped++;
+          for (j = sizeof(int); j < bulkSize; j++) buf[j] = 0;	/* copy on write */
+       }
+       if (remapped != NUM_BULK) {
+          sys_PrintString("Only ");
+          sys_PrintInt(remapped);
+          sys_PrintString(" bulk messages were remapped\n");
+       }
+       sys_Exit(errors);
+    }
+
+    for (i = 0; i < NUM_TEXT; i++) {
+       for (j = 0; j < 6; j++) text[j] = "hello "[j];
+       text[6] = 'a' + i;
+       text[7] = '\0';
+       sys_MsgSend(queue, text, 8);
+    }
+    buf = PageAlign(sendArea);
+    for (i = 0; i < NUM_BULK; i++) {
+       for (j = sizeof(int); j < bulkSize; j++) buf[j] = (char)(i + j);
+       *(int *)buf = sys_GetPA((unsigned)buf);
+       sys_MsgSend(queue, buf, bulkSize);
+    }
+    errors = sys_Join(pid);
+    sys_MsgQueueRemove(queue);
+
+    sys_PrintString("Message test done, errors ");
+    sys_PrintInt(errors);
+    sys_PrintChar('\n');
+    return 0;
+}
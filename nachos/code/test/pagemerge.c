@@ -0,0 +1,48 @@
+#include "syscall.h"
+#define NUM_CHILDREN 4
+#define SIZE (16*256)
+
+int array[SIZE];
+
+int
+main()
+{
+    int i, k, x, sum, expected=0;
+    int child[NUM_CHILDREN];
+
+    for (i=0; i<SIZE; i++) {
+       array[i] = i % 7;
+       expected += array[i];
+    }
+
+    // Every child starts with a byte-identical copy of array[].
+    for (k=0; k<NUM_CHILDREN; k++) {
+       x = sys_Fork();
+       if (x == 0) {
+          sys_Sleep(5000);		// let the merge daemon find the copies
+          for (i=0; i<SIZE; i+=32) array[i] += k;	// one write per page
+          sum = 0;
+          for (i=0; i<SIZE; i++) sum += array[i];
+          sys_PrintString("Child ");
+          sys_PrintInt(k);
+          sys_PrintString(" sum: ");
+          sys_PrintInt(sum);
+          sys_PrintString(" expected: ");
+          sys_PrintInt(expected + k*(SIZE/32));
+          sys_PrintChar('\n');
+          sys_Exit(0);
+       }
+       child[k] = x;
+    }
+
+    for (k=0; k<NUM_CHILDREN; k++) sys_Join(child[k]);
+
+    sum = 0;
+    for (i=0; i<SIZE; i++) sum += array[i];
+    sys_PrintString("Parent sum: ");
+    sys_PrintInt(sum);
+    sys_PrintString(" expected: ");
+    sys_PrintInt(expected);
+    sys_PrintChar('\n');
+    return 0;
+}
@@ -0,0 +1,96 @@
+/* phases.c
+ *	Processes working in phases over shared memory.  In every phase
+ *	all of them check the shared data under a read lock, wait at a
+ *	barrier, and the last one to arrive moves the data on to the next
+ *	phase under a write lock while the others wait at the barrier
+ *	again.  The readers yield while holding the lock so that they
+ *	really overlap; they count themselves with atomic_FetchAdd.
+ *	Finally, check that a process that holds nothing cannot unlock
+ *	somebody else's read lock.
+ */
+
+#include "syscall.h"
+#include "synchop.h"
+
+#define NUM_WORKERS	4
+#define NUM_PHASES	8
+#define NUM_DATA	16
+
+typedef struct {
+   int data[NUM_DATA];
+   int errors;
+   int maxReaders, readers;
+} Shared;
+
+Shared *shared;
+
+int
+main()
+{
+    int pid[NUM_WORKERS], rw, barrier, pair, i, k, phase, readers;
+
+    shared = (Shared *)sys_ShmAllocate(sizeof(Shared));
+    for (k = 0; k < NUM_DATA; k++) shared->data[k] = 0;
+    shared->errors = shared->maxReaders = shared->readers = 0;
+    rw = sys_RWLockGet(11);
+    barrier = sys_BarrierGet(12, NUM_WORKERS);
+
+    for (i = 0; i < NUM_WORKERS; i++) {
+       pid[i] = sys_Fork();
+       if (pid[i] == 0) {
+          for (phase = 0; phase < NUM_PHASES; phase++) {
+             sys_RWLockOp(rw, RWLOCK_OP_READ);
+             readers = atomic_FetchAdd(&shared->readers, 1) + 1;
+             if (readers > shared->maxReaders) shared->maxReaders = readers;
+             for (k = 0; k < NUM_DATA; k++) {
+                if (shared->data[k] != phase) atomic_FetchAdd(&shared->errors, 1);
+                if (k == NUM_DATA/2) sys_Yield();
+             }
+             atomic_FetchAdd(&shared->readers, -1);
+             sys_RWLockOp(rw, RWLOCK_OP_UNLOCK);
+
+             if (sys_BarrierWait(barrier) == 1) {
+                sys_RWLockOp(rw, RWLOCK_OP_WRITE);
+                for (k = 0; k < NUM_DATA; k++) shared->data[k] = phase + 1;
+                sys_RWLockOp(rw, RWLOCK_OP_UNLOCK);
+             }
+             sys_BarrierWait(barrier);
+          }
+          sys_Exit(0);
+       }
+    }
+    for (i = 0; i < NUM_WORKERS; i++) sys_Join(pid[i]);
+
+    if (sys_RWLockOp(rw, RWLOCK_OP_UNLOCK) != -1)
+       sys_PrintString("Unlocking a free lock did not fail\n");
+
+    /* A child reads; our unlock must not count it out */
+    pair = sys_BarrierGet(13, 2);
+    pid[0] = sys_Fork();
+    if (pid[0] == 0) {
+       sys_RWLockOp(rw, RWLOCK_OP_READ);
+       sys_BarrierWait(pair);		/* we hold it */
+       sys_BarrierWait(pair);		/* parent has tried */
+       if (sys_RWLockOp(rw, RWLOCK_OP_UNLOCK) != 0)
+          sys_PrintString("Reader could not unlock\n");
+       sys_Exit(0);
+    }
+    sys_BarrierWait(pair);
+    if (sys_RWLockOp(rw, RWLOCK_OP_UNLOCK) != -1)
+       sys_PrintString("Unlocking another process's read lock did not fail\n");
+    sys_BarrierWait(pair);
+    sys_Join(pid[0]);
+    sys_BarrierRemove(pair);
+    sys_PrintString("Phases done: data ");
+    sys_PrintInt(shared->data[0]);
+    sys_PrintString(" (expected ");
+    sys_PrintInt(NUM_PHASES);
+    sys_PrintString("), errors ");
+    sys_PrintInt(shared->errors);
+    sys_PrintString(", most readers at once ");
+    sys_PrintInt(shared->maxReaders);
+    sys_PrintChar('\n');
+    sys_RWLockRemove(rw);
+    sys_BarrierRemove(barrier);
+    return 0;
+}
@@ -0,0 +1,69 @@
+/* philosophers.c
+ *	Dining philosophers with a semaphore set: semaphore i is fork i,
+ *	and a philosopher takes both its forks with one sys_SemOpMulti,
+ *	so there is no lock ordering to get right and no deadlock.
+ *	Also checks that SEM_NOWAIT fails without taking anything, and
+ *	that the set cannot be removed while somebody waits on it.
+ */
+
+#include "syscall.h"
+#include "synchop.h"
+
+#define NUM_PHILOSOPHERS	5
+#define NUM_MEALS		10
+#define SET_KEY			77
+
+int
+main()
+{
+    SemBuf take[2], put[2];
+    int setId, pid[NUM_PHILOSOPHERS], i, j, one = 1, value;
+
+    setId = sys_SemSetGet(SET_KEY, NUM_PHILOSOPHERS);
+    for (i = 0; i < NUM_PHILOSOPHERS; i++) sys_SemSetCtl(setId, SYNCH_SET, i, &one);
+
+    for (i = 0; i < NUM_PHILOSOPHERS; i++) {
+       pid[i] = sys_Fork();
+       if (pid[i] == 0) {
+          take[0].num = put[0].num = i;
+          take[1].num = put[1].num = (i + 1) % NUM_PHILOSOPHERS;
+          take[0].adjustment = take[1].adjustment = -1;
+          put[0].adjustment = put[1].adjustment = 1;
+          for (j = 0; j < NUM_MEALS; j++) {
+             sys_SemOpMulti(setId, take, 2, 0);
+             sys_Yield();			/* eat */
+             sys_SemOpMulti(setId, put, 2, 0);
+             sys_Yield();			/* think */
+          }
+          sys_Exit(i);
+       }
+    }
+    for (i = 0; i < NUM_PHILOSOPHERS; i++) sys_Join(pid[i]);
+
+    /* All forks are back; take fork 0 twice without waiting */
+    take[0].num = take[1].num = 0;
+    take[0].adjustment = take[1].adjustment = -1;
+    if (sys_SemOpMulti(setId, take, 2, SEM_NOWAIT) != -1)
+       sys_PrintString("SEM_NOWAIT did not fail\n");
+    sys_SemSetCtl(setId, SYNCH_GET, 0, &value);
+    sys_PrintString("Philosophers done, fork 0 value ");
+    sys_PrintInt(value);
+    sys_PrintString(" (expected 1)\n");
+
+    /* Leave a child asleep on fork 0, then try to remove the set */
+    value = 0;
+    sys_SemSetCtl(setId, SYNCH_SET, 0, &value);
+    pid[0] = sys_Fork();
+    if (pid[0] == 0) {
+       sys_SemOpMulti(setId, take, 1, 0);
+       sys_Exit(0);
+    }
+    for (i = 0; i < NUM_PHILOSOPHERS; i++) sys_Yield();
+    if (sys_SemSetCtl(setId, SYNCH_REMOVE, 0, 0) != -1)
+       sys_PrintString("SYNCH_REMOVE did not fail with a waiter\n");
+    sys_SemSetCtl(setId, SYNCH_SET, 0, &one);
+    sys_Join(pid[0]);
+    if (sys_SemSetCtl(setId, SYNCH_REMOVE, 0, 0) != 0)
+       sys_PrintString("SYNCH_REMOVE failed\n");
+    return 0;
+}
@@ -0,0 +1,99 @@
+/* pipetest.c
+ *	A three stage pipeline of forked processes: the first writes
+ *	numbered bytes into a pipe, the second copies them to a second
+ *	pipe a few at a time, and the parent checks what comes out.
+ *	Also checks end of file and writing to a pipe nobody reads, and
+ *	runs itself as a spawned pipeline whose reader exits first: the
+ *	writer must then fail instead of waiting forever.
+ */
+
+#include "syscall.h"
+
+#define NUM_BYTES	3000
+
+int
+main(int argc, char **argv)
+{
+    int first[2], second[2], pid1, pid2, i, n, total, errors = 0;
+    char buffer[100], *args[3];
+
+    if (argc == 2) {				/* a spawned stage */
+       if (argv[1][0] == 'q') return 0;		/* "quit": read nothing */
+       for (i = 0; i < 100; i++) buffer[i] = (char)i;	/* "produce" */
+       while (sys_Write(buffer, 100, ConsoleOutput) == 100) ;
+       return 0;
+    }
+
+    sys_Pipe(first);
+    sys_Pipe(second);
+
+    pid1 = sys_Fork();
+    if (pid1 == 0) {				/* producer */
+       sys_Close(first[0]);
+       sys_Close(second[0]);
+       sys_Close(second[1]);
+       for (total = 0; total < NUM_BYTES; total += n) {
+          n = (NUM_BYTES - total < 100) ? (NUM_BYTES - total) : 100;
+          for (i = 0; i < n; i++) buffer[i] = (char)(total + i);
+          sys_Write(buffer, n, first[1]);
+       }
+       sys_Exit(0);
+    }
+
+    pid2 = sys_Fork();
+    if (pid2 == 0) {				/* filter, reading stdin */
+       sys_Dup2(first[0], ConsoleInput);
+       sys_Dup2(second[1], ConsoleOutput);
+       sys_Close(first[0]);
+       sys_Close(first[1]);
+       sys_Close(second[0]);
+       sys_Close(second[1]);
+       while ((n = sys_Read(buffer, 7, ConsoleInput)) > 0)
+          sys_Write(buffer, n, ConsoleOutput);
+       sys_Exit(0);
+    }
+
+    sys_Close(first[0]);
+    sys_Close(first[1]);
+    sys_Close(second[1]);
+    total = 0;
+    while ((n = sys_Read(buffer, sizeof(buffer), second[0])) > 0) {
+       for (i = 0; i < n; i++)
+          if (buffer[i] != (char)(total + i)) errors++;
+       total += n;
+    }
+    sys_Join(pid1);
+    sys_Join(pid2);
+    if (total != NUM_BYTES) errors++;
+
+    sys_Close(second[0]);
+    sys_Pipe(first);
+    sys_Close(first[0]);
+    if (sys_Write(buffer, 1, first[1]) != -1) errors++;	/* no reader */
+    sys_Close(first[1]);
+
+    /* argv[0] produce | argv[0] quit, started the way the shell does */
+    sys_Pipe(first);
+    sys_Dup2(first[1], ConsoleOutput);
+    sys_Close(first[1]);
+    args[0] = argv[0];
+    args[1] = "produce";
+    args[2] = 0;
+    pid1 = sys_Spawn(argv[0], args);
+    sys_Close(ConsoleOutput);
+    sys_Dup2(first[0], ConsoleInput);
+    sys_Close(first[0]);
+    args[1] = "quit";
+    pid2 = sys_Spawn(argv[0], args);
+    sys_Close(ConsoleInput);
+    if ((pid1 < 0) || (pid2 < 0)) errors++;
+    if (pid2 >= 0) sys_Join(pid2);
+    if (pid1 >= 0) sys_Join(pid1);		/* hangs if the write never fails */
+
+    sys_PrintString("Pipe test done: ");
+    sys_PrintInt(total);
+    sys_PrintString(" bytes, errors ");
+    sys_PrintInt(errors);
+    sys_PrintChar('\n');
+    return 0;
+}
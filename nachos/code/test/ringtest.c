@@ -0,0 +1,101 @@
+/* ringtest.c
+ *	Write a file and read it back through the asynchronous call ring,
+ *	counting loop iterations done while the requests are in flight.
+ *	Then let short-lived children set up rings of their own and exit
+ *	with a Read in flight; their rings must not use up memory.
+ */
+
+#include "syscall.h"
+#include "ring.h"
+
+#define ENTRIES	8
+#define SIZE	2048
+#define CHILDREN	16		/* their rings add up to more than
+					   the default memory */
+
+int *ring;
+
+void
+submit(int op, int arg, char *buffer, int count, int userData)
+{
+    int *sqe = RING_SQE(ring, ring[RING_SQ_TAIL]);
+
+    sqe[RING_SQE_OP] = op;
+    sqe[RING_SQE_ARG] = arg;
+    sqe[RING_SQE_BUFFER] = (int)buffer;
+    sqe[RING_SQE_COUNT] = count;
+    sqe[RING_SQE_USER_DATA] = userData;
+    ring[RING_SQ_TAIL]++;
+}
+
+void
+harvest()
+{
+    int *cqe;
+
+    while (ring[RING_CQ_HEAD] != ring[RING_CQ_TAIL]) {
+       cqe = RING_CQE(ring, ring[RING_CQ_HEAD]);
+       sys_PrintString("request ");
+       sys_PrintInt(cqe[RING_CQE_USER_DATA]);
+       sys_PrintString(" returned ");
+       sys_PrintInt(cqe[RING_CQE_RESULT]);
+       sys_PrintChar('\n');
+       ring[RING_CQ_HEAD]++;
+    }
+}
+
+int
+main()
+{
+    int i, fd, pid, spins = 0;
+    char *out, *in;
+
+    ring = sys_RingSetup(ENTRIES, 2 * SIZE);
+    if (ring == (int *)-1) {
+       sys_PrintString("RingSetup failed\n");
+       return 1;
+    }
+    out = RING_DATA(ring);
+    in = out + SIZE;
+    for (i=0; i<SIZE; i++) out[i] = 'A' + (i % 26);
+
+    sys_Create("ringtest.out");
+    fd = sys_Open("ringtest.out");
+    submit(RING_OP_WRITE, fd, out, SIZE, 1);
+    submit(RING_OP_SLEEP, 500, 0, 0, 2);
+    submit(RING_OP_WRITE, ConsoleOutput, out, 26, 3);
+    submit(RING_OP_NOP, 0, 0, 0, 4);
+    sys_RingEnter(0);				/* one trap for four requests */
+    while (ring[RING_CQ_TAIL] - ring[RING_CQ_HEAD] < 4)
+       spins++;				/* completions show up in memory */
+    sys_PrintChar('\n');
+    harvest();
+    sys_Close(fd);
+
+    fd = sys_Open("ringtest.out");
+    submit(RING_OP_READ, fd, in, SIZE, 5);
+    sys_RingEnter(1);
+    harvest();
+    for (i=0; i<SIZE; i++) if (in[i] != out[i]) break;
+    sys_PrintString((i == SIZE) ? "contents match\n" : "contents differ\n");
+    sys_PrintString("iterations while waiting: ");
+    sys_PrintInt(spins);
+    sys_PrintChar('\n');
+
+    for (i=0; i<CHILDREN; i++) {
+       pid = sys_Fork();
+       if (pid == 0) {
+          out[0] = '?';			/* our copy, not the parent's ring */
+          ring = sys_RingSetup(ENTRIES, 8 * SIZE);
+          if (ring == (int *)-1) sys_Exit(1);
+          submit(RING_OP_READ, fd, RING_DATA(ring), SIZE, 6);
+          sys_RingEnter(0);
+          sys_Yield();			/* let the worker start on it */
+          sys_Exit(0);
+       }
+       if (sys_Join(pid) != 0) break;
+    }
+    sys_PrintString(((i == CHILDREN) && (out[0] == 'A')) ?
+                    "child rings freed\n" : "child rings failed\n");
+    return 0;
+}
@@ -7,7 +7,10 @@ main()
     OpenFileId input = ConsoleInput;
     OpenFileId output = ConsoleOutput;
     char prompt[2], ch, buffer[60];
-    int i;
+    char *args[16];
+    int i, argc;
+    int stage[8], numStages, s, ids[2], in;
+    SpaceId pids[8];
 
     prompt[0] = '-';
     prompt[1] = '-';
@@ -28,10 +31,59 @@ main()
 
 	buffer[--i] = '\0';
 
-	/*if( i > 0 ) {
-		newProc = sys_Exec(buffer);
-		sys_Join(newProc);
-	}*/
+	/* Split the line into words.  A "|" word ends the argument
+	 * vector of one stage of a pipeline and starts the next. */
+	argc = 0;
+	for (i = 0; buffer[i] != '\0'; i++) {
+	    if (buffer[i] == ' ') buffer[i] = '\0';
+	    else if (((i == 0) || (buffer[i-1] == '\0')) && (argc < 15))
+		args[argc++] = &buffer[i];
+	}
+	args[argc] = 0;
+	numStages = 1;
+	stage[0] = 0;
+	for (i = 0; i < argc; i++) {
+	    if ((args[i][0] == '|') && (args[i][1] == '\0') && (numStages < 8)) {
+		args[i] = 0;
+		stage[numStages++] = i + 1;
+	    }
+	}
+
+	/* Run the stages, each reading from a pipe filled by the one
+	 * before.  Our own copies of the pipe ends are closed as soon as
+	 * the stage is started, so that the reader of a pipe sees end of
+	 * file when its writer exits.  A stage gets only ConsoleInput and
+	 * ConsoleOutput from sys_Spawn, not the read end we keep for the
+	 * next stage, so its writes fail once that stage is gone. */
+	if( argc > 0 ) {
+		in = -1;
+		for (s = 0; s < numStages; s++) {
+		    pids[s] = -1;
+		    if ((s < numStages - 1) && (sys_Pipe(ids) < 0)) break;
+		    if (in >= 0) {
+			sys_Dup2(in, ConsoleInput);
+			sys_Close(in);
+			in = ConsoleInput;
+		    }
+		    if (s < numStages - 1) {
+			sys_Dup2(ids[1], ConsoleOutput);
+			sys_Close(ids[1]);
+		    }
+		    if (args[stage[s]] != 0)
+			pids[s] = sys_Spawn(args[stage[s]], &args[stage[s]]);
+		    if (in >= 0) sys_Close(ConsoleInput);
+		    in = -1;
+		    if (s < numStages - 1) {
+			sys_Close(ConsoleOutput);
+			in = ids[0];
+		    }
+		}
+		if (in >= 0) sys_Close(in);	/* a pipe was left unread */
+		for (i = 0; i < s; i++) {
+		    newProc = pids[i];
+		    if (newProc >= 0) sys_Join(newProc);
+		}
+	}
     }
 }
 
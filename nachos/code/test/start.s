@@ -45,6 +45,7 @@ __start:
 	.globl sys_Halt
 	.ent	sys_Halt
 sys_Halt:
+	jal	batch_Flush	/* never returns, so $31 can go */
 	addiu $2,$0,syscall_Halt
 	syscall
 	j	$31
@@ -53,6 +54,9 @@ sys_Halt:
 	.globl sys_Exit
 	.ent	sys_Exit
 sys_Exit:
+	move	$24,$4		/* the kernel leaves $24 alone */
+	jal	batch_Flush	/* never returns, so $31 can go */
+	move	$4,$24
 	addiu $2,$0,syscall_Exit
 	syscall
 	j	$31
@@ -117,6 +121,9 @@ sys_Close:
 	.globl sys_Fork
 	.ent	sys_Fork
 sys_Fork:
+	move	$24,$31		/* the kernel and batch_Flush leave $24 alone */
+	jal	batch_Flush	/* or the child prints our queue again */
+	move	$31,$24
 	addiu $2,$0,syscall_Fork
 	syscall
 	j	$31
@@ -274,6 +281,388 @@ sys_ShmAllocate:
         j       $31
         .end sys_ShmAllocate
 
+        .globl sys_MemStat
+        .ent    sys_MemStat
+sys_MemStat:
+	addiu $2,$0,syscall_MemStat
+        syscall
+        j       $31
+        .end sys_MemStat
+
+        .globl sys_SetMemLimit
+        .ent    sys_SetMemLimit
+sys_SetMemLimit:
+	addiu $2,$0,syscall_SetMemLimit
+        syscall
+        j       $31
+        .end sys_SetMemLimit
+
+        .globl sys_RingSetup
+        .ent    sys_RingSetup
+sys_RingSetup:
+	addiu $2,$0,syscall_RingSetup
+        syscall
+        j       $31
+        .end sys_RingSetup
+
+        .globl sys_RingEnter
+        .ent    sys_RingEnter
+sys_RingEnter:
+	addiu $2,$0,syscall_RingEnter
+        syscall
+        j       $31
+        .end sys_RingEnter
+
+        .globl sys_Batch
+        .ent    sys_Batch
+sys_Batch:
+	addiu $2,$0,syscall_Batch
+        syscall
+        j       $31
+        .end sys_Batch
+
+        .globl sys_Spawn
+        .ent    sys_Spawn
+sys_Spawn:
+	addiu $2,$0,syscall_Spawn
+        syscall
+        j       $31
+        .end sys_Spawn
+
+        .globl sys_FutexWait
+        .ent    sys_FutexWait
+sys_FutexWait:
+	addiu $2,$0,syscall_FutexWait
+        syscall
+        j       $31
+        .end sys_FutexWait
+
+        .globl sys_FutexWake
+        .ent    sys_FutexWake
+sys_FutexWake:
+	addiu $2,$0,syscall_FutexWake
+        syscall
+        j       $31
+        .end sys_FutexWake
+
+        .globl sys_SetAtomicRegion
+        .ent    sys_SetAtomicRegion
+sys_SetAtomicRegion:
+	addiu $2,$0,syscall_SetAtomicRegion
+        syscall
+        j       $31
+        .end sys_SetAtomicRegion
+
+        .globl sys_SemSetGet
+        .ent    sys_SemSetGet
+sys_SemSetGet:
+	addiu $2,$0,syscall_SemSetGet
+        syscall
+        j       $31
+        .end sys_SemSetGet
+
+        .globl sys_SemOpMulti
+        .ent    sys_SemOpMulti
+sys_SemOpMulti:
+	addiu $2,$0,syscall_SemOpMulti
+        syscall
+        j       $31
+        .end sys_SemOpMulti
+
+        .globl sys_SemSetCtl
+        .ent    sys_SemSetCtl
+sys_SemSetCtl:
+	addiu $2,$0,syscall_SemSetCtl
+        syscall
+        j       $31
+        .end sys_SemSetCtl
+
+        .globl sys_RWLockGet
+        .ent    sys_RWLockGet
+sys_RWLockGet:
+	addiu $2,$0,syscall_RWLockGet
+        syscall
+        j       $31
+        .end sys_RWLockGet
+
+        .globl sys_RWLockOp
+        .ent    sys_RWLockOp
+sys_RWLockOp:
+	addiu $2,$0,syscall_RWLockOp
+        syscall
+        j       $31
+        .end sys_RWLockOp
+
+        .globl sys_RWLockRemove
+        .ent    sys_RWLockRemove
+sys_RWLockRemove:
+	addiu $2,$0,syscall_RWLockRemove
+        syscall
+        j       $31
+        .end sys_RWLockRemove
+
+        .globl sys_BarrierGet
+        .ent    sys_BarrierGet
+sys_BarrierGet:
+	addiu $2,$0,syscall_BarrierGet
+        syscall
+        j       $31
+        .end sys_BarrierGet
+
+        .globl sys_BarrierWait
+        .ent    sys_BarrierWait
+sys_BarrierWait:
+	addiu $2,$0,syscall_BarrierWait
+        syscall
+        j       $31
+        .end sys_BarrierWait
+
+        .globl sys_BarrierRemove
+        .ent    sys_BarrierRemove
+sys_BarrierRemove:
+	addiu $2,$0,syscall_BarrierRemove
+        syscall
+        j       $31
+        .end sys_BarrierRemove
+
+        .globl sys_MsgQueueGet
+        .ent    sys_MsgQueueGet
+sys_MsgQueueGet:
+	addiu $2,$0,syscall_MsgQueueGet
+        syscall
+        j       $31
+        .end sys_MsgQueueGet
+
+        .globl sys_MsgSend
+        .ent    sys_MsgSend
+sys_MsgSend:
+	addiu $2,$0,syscall_MsgSend
+        syscall
+        j       $31
+        .end sys_MsgSend
+
+        .globl sys_MsgReceive
+        .ent    sys_MsgReceive
+sys_MsgReceive:
+	addiu $2,$0,syscall_MsgReceive
+        syscall
+        j       $31
+        .end sys_MsgReceive
+
+        .globl sys_MsgQueueRemove
+        .ent    sys_MsgQueueRemove
+sys_MsgQueueRemove:
+	addiu $2,$0,syscall_MsgQueueRemove
+        syscall
+        j       $31
+        .end sys_MsgQueueRemove
+
+        .globl sys_Pipe
+        .ent    sys_Pipe
+sys_Pipe:
+	addiu $2,$0,syscall_Pipe
+        syscall
+        j       $31
+        .end sys_Pipe
+
+        .globl sys_Dup2
+        .ent    sys_Dup2
+sys_Dup2:
+	addiu $2,$0,syscall_Dup2
+        syscall
+        j       $31
+        .end sys_Dup2
+
+        .globl sys_PageSize
+        .ent    sys_PageSize
+sys_PageSize:
+	addiu $2,$0,syscall_PageSize
+        syscall
+        j       $31
+        .end sys_PageSize
+
+/* -------------------------------------------------------------
+ * Atomic operations:
+ *	atomic_CompareSwap is the restartable atomic sequence of the
+ *	program, from its first instruction up to atomicEnd.  A thread
+ *	switched out anywhere in between is restarted at the load, so
+ *	the load and the store always happen without anybody else
+ *	running in between.  atomic_Setup tells the kernel where it is.
+ * -------------------------------------------------------------
+ */
+
+        .globl atomic_Setup
+        .ent    atomic_Setup
+atomic_Setup:
+	la	$4,atomic_CompareSwap
+	la	$5,atomicEnd
+	addiu $2,$0,syscall_SetAtomicRegion
+        syscall
+        j       $31
+        .end atomic_Setup
+
+        .globl atomic_CompareSwap
+        .ent    atomic_CompareSwap
+atomic_CompareSwap:
+	.set	noreorder
+	lw	$2,0($4)
+	nop			/* load delay */
+	bne	$2,$5,atomicEnd
+	nop
+	sw	$6,0($4)
+atomicEnd:
+        j       $31
+	nop
+	.set	reorder
+        .end atomic_CompareSwap
+
+/* -------------------------------------------------------------
+ * Batched calls:
+ *	batch_PrintInt, batch_PrintChar, batch_PrintIntHex and
+ *	batch_PrintString queue their call in batchBuffer instead of
+ *	trapping.  The queue goes to the kernel in a single sys_Batch
+ *	when it is full, when batch_Flush is called, and before Fork,
+ *	Exit and Halt.  batchBuffer is the count of queued calls followed by
+ *	BATCH_QUEUE BatchRecords.
+ * -------------------------------------------------------------
+ */
+
+#define BATCH_QUEUE	16
+#define BATCH_RECORD_SIZE	(BATCH_RECORD_WORDS * 4)
+
+	.comm	batchBuffer,4+BATCH_QUEUE*BATCH_RECORD_SIZE
+
+	.globl batch_PrintInt
+	.ent	batch_PrintInt
+batch_PrintInt:
+	addiu $2,$0,syscall_PrintInt
+	j	batchAdd
+	.end batch_PrintInt
+
+	.globl batch_PrintChar
+	.ent	batch_PrintChar
+batch_PrintChar:
+	addiu $2,$0,syscall_PrintChar
+	j	batchAdd
+	.end batch_PrintChar
+
+	.globl batch_PrintIntHex
+	.ent	batch_PrintIntHex
+batch_PrintIntHex:
+	addiu $2,$0,syscall_PrintIntHex
+	j	batchAdd
+	.end batch_PrintIntHex
+
+	.globl batch_PrintString
+	.ent	batch_PrintString
+batch_PrintString:
+	addiu $2,$0,syscall_PrintString
+	j	batchAdd
+	.end batch_PrintString
+
+/* Append the call with code $2 and arguments $4..$7 to the queue */
+	.ent	batchAdd
+batchAdd:
+	la	$8,batchBuffer
+	lw	$9,0($8)		/* queued calls */
+	sll	$10,$9,4		/* record offset = count * 24 */
+	sll	$11,$9,3
+	addu	$10,$10,$11
+	addu	$10,$10,$8
+	sw	$2,4($10)		/* code */
+	sw	$4,8($10)		/* args */
+	sw	$5,12($10)
+	sw	$6,16($10)
+	sw	$7,20($10)
+	addiu	$9,$9,1
+	sw	$9,0($8)
+	slti	$11,$9,BATCH_QUEUE
+	beq	$11,$0,batch_Flush	/* queue full */
+	j	$31
+	.end batchAdd
+
+/* Send the queued calls to the kernel; returns how many completed */
+	.globl batch_Flush
+	.ent	batch_Flush
+batch_Flush:
+	la	$8,batchBuffer
+	lw	$5,0($8)
+	move	$2,$0
+	beq	$5,$0,batchEmpty
+	sw	$0,0($8)
+	addiu	$4,$8,4
+	addiu $2,$0,syscall_Batch
+	syscall
+batchEmpty:
+	j	$31
+	.end batch_Flush
+
+/* -------------------------------------------------------------
+ * Load linked / store conditional:
+ *	LL and SC are MIPS II instructions; the simulator reserves
+ *	the line read by LL and lets SC store only if nobody stored to
+ *	it and no context switch happened since.  atomic_LoadLinked and
+ *	atomic_StoreConditional expose the pair to C (SC returns 1 if
+ *	it stored, 0 if not); atomic_FetchAdd and atomic_Swap are the
+ *	usual retry loops.  None of them need atomic_Setup.
+ * -------------------------------------------------------------
+ */
+
+	.set	mips2
+
+	.globl	atomic_LoadLinked
+	.ent	atomic_LoadLinked
+atomic_LoadLinked:
+	.set	noreorder
+	ll	$2,0($4)
+	j	$31
+	nop			/* load delay */
+	.set	reorder
+	.end	atomic_LoadLinked
+
+	.globl	atomic_StoreConditional
+	.ent	atomic_StoreConditional
+atomic_StoreConditional:
+	move	$2,$5
+	sc	$2,0($4)
+	j	$31
+	.end	atomic_StoreConditional
+
+/* int atomic_FetchAdd (int *addr, int delta): returns the old value */
+	.globl	atomic_FetchAdd
+	.ent	atomic_FetchAdd
+atomic_FetchAdd:
+	.set	noreorder
+fetchAddRetry:
+	ll	$2,0($4)
+	nop			/* load delay */
+	addu	$8,$2,$5
+	sc	$8,0($4)
+	beq	$8,$0,fetchAddRetry
+	nop
+	j	$31
+	nop
+	.set	reorder
+	.end	atomic_FetchAdd
+
+/* int atomic_Swap (int *addr, int value): returns the old value */
+	.globl	atomic_Swap
+	.ent	atomic_Swap
+atomic_Swap:
+	.set	noreorder
+swapRetry:
+	ll	$2,0($4)
+	move	$8,$5		/* also the load delay */
+	sc	$8,0($4)
+	beq	$8,$0,swapRetry
+	nop
+	j	$31
+	nop
+	.set	reorder
+	.end	atomic_Swap
+
+	.set	mips0
+
 /* dummy function to keep gcc happy */
         .globl  __main
         .ent    __main
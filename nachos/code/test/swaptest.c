@@ -0,0 +1,31 @@
+#include "syscall.h"
+#define SIZE (48*1024)		// more than physical memory
+#define PAGE_INTS 32
+
+int array[SIZE];
+
+int
+main()
+{
+    int i, k, sum=0, expected=0;
+
+    // Even pages compress well, odd pages do not.
+    for (i=0; i<SIZE; i++) {
+       if ((i/PAGE_INTS) % 2 == 0) array[i] = i % 3;
+       else array[i] = i * 1103515245 + 12345;
+       expected += array[i];
+    }
+
+    // Touch everything twice so that evicted dirty pages are read back.
+    for (k=0; k<2; k++) {
+       sum = 0;
+       for (i=0; i<SIZE; i++) sum += array[i];
+    }
+
+    sys_PrintString("Total sum: ");
+    sys_PrintInt(sum);
+    sys_PrintString(" expected: ");
+    sys_PrintInt(expected);
+    sys_PrintChar('\n');
+    return 0;
+}
@@ -4,7 +4,7 @@ int
 main()
 {
     sys_PrintString("Before calling Exec.\n");
-    sys_Exec("../test/vectorsum");
+    sys_Exec("../test/vectorsum", 0);
     sys_PrintString("Returned from Exec.\n"); // Should never return
     return 0;
 }
@@ -0,0 +1,20 @@
+/* upper.c
+ *	Copy ConsoleInput to ConsoleOutput in upper case, until end of
+ *	file.  Meant to be a stage of a shell pipeline.
+ */
+
+#include "syscall.h"
+
+int
+main()
+{
+    char buffer[64];
+    int i, n;
+
+    while ((n = sys_Read(buffer, sizeof(buffer), ConsoleInput)) > 0) {
+       for (i = 0; i < n; i++)
+          if ((buffer[i] >= 'a') && (buffer[i] <= 'z')) buffer[i] += 'A' - 'a';
+       sys_Write(buffer, n, ConsoleOutput);
+    }
+    return 0;
+}
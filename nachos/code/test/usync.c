@@ -0,0 +1,103 @@
+/* usync.c
+ *	User-level mutexes and semaphores, see usync.h.
+ *
+ *	The mutex is the three state futex mutex: the uncontended lock is
+ *	a single compare and swap from 0 to 1, and only an unlock that
+ *	finds the state at 2 calls sys_FutexWake.  There is no spinning
+ *	before going to sleep; with a single processor, the holder cannot
+ *	run while we spin.
+ */
+
+#include "syscall.h"
+#include "usync.h"
+
+static int atomicReady = 0;	/* atomic_Setup done in this program */
+
+static void
+Setup ()
+{
+   if (!atomicReady) {
+      atomic_Setup();
+      atomicReady = 1;
+   }
+}
+
+static int
+Exchange (int *addr, int value)
+{
+   int old;
+
+   do {
+      old = *addr;
+   } while (atomic_CompareSwap(addr, old, value) != old);
+   return old;
+}
+
+static int
+FetchAdd (int *addr, int delta)
+{
+   int old;
+
+   do {
+      old = *addr;
+   } while (atomic_CompareSwap(addr, old, old + delta) != old);
+   return old;
+}
+
+void
+umutex_Init (UMutex *m)
+{
+   Setup();
+   *m = 0;
+}
+
+void
+umutex_Lock (UMutex *m)
+{
+   int c = atomic_CompareSwap(m, 0, 1);
+
+   if (c == 0) return;			/* it was free: no trap */
+   if (c != 2) c = Exchange(m, 2);
+   while (c != 0) {
+      sys_FutexWait(m, 2);
+      c = Exchange(m, 2);
+   }
+}
+
+void
+umutex_Unlock (UMutex *m)
+{
+   if (Exchange(m, 0) == 2) sys_FutexWake(m, 1);
+}
+
+void
+usem_Init (USemaphore *s, int value)
+{
+   Setup();
+   s->value = value;
+   s->waiters = 0;
+}
+
+void
+usem_P (USemaphore *s)
+{
+   int v;
+
+   for (;;) {
+      v = s->value;
+      if (v > 0) {
+         if (atomic_CompareSwap(&s->value, v, v - 1) == v) return;
+         continue;
+      }
+      FetchAdd(&s->waiters, 1);
+      sys_FutexWait(&s->value, 0);	/* returns at once if a V came first */
+      FetchAdd(&s->waiters, -1);
+   }
+}
+
+void
+usem_V (USemaphore *s)
+{
+   FetchAdd(&s->value, 1);
+   if (s->waiters > 0) sys_FutexWake(&s->value, 1);
+}
@@ -0,0 +1,30 @@
+/* usync.h
+ *	Mutexes and semaphores for user programs, built on
+ *	atomic_CompareSwap and the futex calls.  They only trap into the
+ *	kernel to sleep or to wake a sleeper; taking a free mutex or a
+ *	semaphore with a positive count is done entirely in user mode.
+ *
+ *	Put them in memory from sys_ShmAllocate to use them between
+ *	processes.  Link the program with usync.o.
+ */
+
+#ifndef USYNC_H
+#define USYNC_H
+
+/* A mutex is one word: 0 free, 1 locked, 2 locked and maybe waited on */
+typedef int UMutex;
+
+typedef struct {
+   int value;
+   int waiters;			/* threads that may be sleeping in P */
+} USemaphore;
+
+void umutex_Init (UMutex *m);
+void umutex_Lock (UMutex *m);
+void umutex_Unlock (UMutex *m);
+
+void usem_Init (USemaphore *s, int value);
+void usem_P (USemaphore *s);
+void usem_V (USemaphore *s);
+
+#endif
@@ -0,0 +1,28 @@
+/* writetest.c
+ *	Print a lot of short lines, through sys_Write and through the
+ *	sys_Print* calls, to exercise the kernel console buffer.
+ */
+
+#include "syscall.h"
+
+#define LINES 50
+
+int
+main()
+{
+    int i, start = sys_GetTime();
+    char line[] = "0123456789abcdefghijklmnopqrstuvwxyz\n";
+
+    for (i=0; i<LINES; i++) {
+       sys_Write(line, sizeof(line)-1, ConsoleOutput);
+       sys_PrintString("line ");
+       sys_PrintInt(i);
+       sys_PrintChar(' ');
+       sys_PrintIntHex(i);
+       sys_PrintChar('\n');
+    }
+    sys_PrintString("Ticks spent printing: ");
+    sys_PrintInt(sys_GetTime() - start);
+    sys_PrintChar('\n');
+    return 0;
+}
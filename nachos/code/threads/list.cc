@@ -17,7 +17,10 @@
 
 #include "copyright.h"
 #include "list.h"
-#include "thread.h"
+#include "slab.h"
+
+// Every Append, Prepend and SortedInsert needs an element
+static SlabPool listElementPool("ListElement", sizeof(ListElement));
 
 //----------------------------------------------------------------------
 // ListElement::ListElement
@@ -35,6 +38,25 @@ ListElement::ListElement(void *itemPtr, int sortKey)
      next = NULL;	// assume we'll put it at the end of the list 
 }
 
+//----------------------------------------------------------------------
+// ListElement::operator new, ListElement::operator delete
+// 	List elements are recycled through listElementPool instead of
+//	going to the heap.
+//----------------------------------------------------------------------
+
+void *
+ListElement::operator new(size_t size)
+{
+    ASSERT(size == sizeof(ListElement));
+    return listElementPool.Alloc();
+}
+
+void
+ListElement::operator delete(void *element)
+{
+    listElementPool.Free(element);
+}
+
 //----------------------------------------------------------------------
 // List::List
 //	Initialize a list, empty to start with.
@@ -236,46 +258,3 @@ List::SortedRemove(int *keyPtr)
     delete element;
     return thing;
 }
-
-void*
-List::GetMinPriorityThread (void)
-{
-   ListElement *ptr=first, *prev=NULL, *minptr=ptr, *minprev=prev;
-   void *thing;
-   int minimum;
-
-    if (IsEmpty())
-        return NULL;
-
-    if (first == last) {        // list had one item, now has none
-        thing = first->item;
-        first = NULL;
-        last = NULL;
-    } else {
-        minimum = ((Thread*)(minptr->item))->GetPriority();
-        for (ptr = first->next, prev = first; ptr != NULL; prev = ptr, ptr = ptr->next) {
-           if (((Thread*)(ptr->item))->GetPriority() < minimum) {
-              minptr = ptr;
-              minprev = prev;
-              minimum = ((Thread*)(minptr->item))->GetPriority();
-           }
-        }
-        ASSERT(minptr != NULL);
-        ASSERT(minimum == ((Thread*)(minptr->item))->GetPriority());
-        thing = minptr->item;
-        if (minprev == NULL) { // First element has minimum priority
-           first = first->next;
-        }
-        else if (minptr->next == NULL) { // Last element has minimum priority
-           ASSERT(minprev->next == minptr);
-           minprev->next = NULL;
-           last = minprev;
-        }
-        else {
-           ASSERT(minprev->next == minptr);
-           minprev->next = minptr->next;
-        }
-    }
-    delete minptr;
-    return thing;
-}
@@ -28,6 +28,9 @@ class ListElement {
    public:
      ListElement(void *itemPtr, int sortKey);	// initialize a list element
 
+     void *operator new(size_t size);	// Elements come from a SlabPool
+     void operator delete(void *element);	// (see slab.h)
+
      ListElement *next;		// next element on list, 
 				// NULL if this is the last
      int key;		    	// priority, for a sorted list
@@ -58,8 +61,6 @@ class List {
     void SortedInsert(void *item, int sortKey);	// Put item into list
     void *SortedRemove(int *keyPtr); 	  	// Remove first item from list
 
-    void *GetMinPriorityThread (void);
-
   private:
     ListElement *first;  	// Head of the list, NULL if list is empty
     ListElement *last;		// Last element of list
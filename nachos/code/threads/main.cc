@@ -8,7 +8,7 @@
 //
 // 	Most of this file is not needed until later assignments.
 //
-// Usage: nachos -d <debugflags> -rs <random seed #>
+// Usage: nachos -d <debugflags> -rs <random seed #> -fs
 //		-s -x <nachos file> -c <consoleIn> <consoleOut>
 //		-f -cp <unix file> <nachos file>
 //		-p <nachos file> -r <nachos file> -l -D -t
@@ -18,12 +18,26 @@
 //
 //    -d causes certain debugging messages to be printed (cf. utility.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
+//    -fs checks canary words at every context switch instead of putting
+//       guard pages around thread stacks (faster Fork)
 //    -z prints the copyright message
 //
 //  USER_PROGRAM
 //    -s causes user programs to be executed in single-step mode
+//    -np <frames> sets the number of physical frames (default 1024)
+//    -ps <bytes> sets the page size, a multiple of 4 (default SectorSize)
 //    -x runs a user program
 //    -c tests the console
+//    -K [ticks] merges identical pages every "ticks" ticks (must come
+//       before -x or -F)
+//    -Z <percent> keeps evicted pages in a compressed pool of up to
+//       percent% of physical memory before using backing store
+//    -M <pages> limits every process to "pages" resident private pages,
+//       replacing its own pages beyond that (must come after -R and
+//       before -x or -F)
+//    -ss prints per-syscall counts and latency histograms at halt
+//    -st <file> also writes a binary trace of every syscall to the UNIX
+//       file "file" (both must come before -x or -F)
 //
 //  FILESYS
 //    -f causes the physical disk to be formatted
@@ -52,6 +66,10 @@
 
 #include "utility.h"
 #include "system.h"
+#ifdef USER_PROGRAM
+#include "pagemerge.h"
+#include "syscall.h"
+#endif
 
 
 // External functions used by this file
@@ -116,6 +134,31 @@ main(int argc, char **argv)
             currentThread->SetBasePriority(schedPriority+DEFAULT_BASE_PRIORITY);
             currentThread->SetPriority(schedPriority+DEFAULT_BASE_PRIORITY);
             currentThread->SetUsage(0);
+        } else if (!strcmp(*argv, "-K")) {	// merge identical pages
+            if ((argc > 1) && (atoi(*(argv + 1)) > 0)) {
+               StartPageMergeDaemon(atoi(*(argv + 1)));
+               argCount = 2;
+            }
+            else StartPageMergeDaemon(DEFAULT_MERGE_INTERVAL);
+        } else if (!strcmp(*argv, "-Z")) {	// compressed swap pool
+            int poolPercent = atoi(*(argv + 1));
+            argCount = 2;
+            ASSERT((poolPercent >= 0) && (poolPercent <= MAX_POOL_PERCENT));
+            if (poolPercent > 0)
+               compressedPool = new CompressedPool((poolPercent * NumPhysPages / 100) * PageSize, PageSize);
+        } else if (!strcmp(*argv, "-M")) {	// resident-set limit
+            ASSERT(argc > 1);
+            defaultResidentLimit = atoi(*(argv + 1));
+            ASSERT(defaultResidentLimit >= 0);
+            ASSERT((defaultResidentLimit == 0) || (replacementAlgo != 0));	// -R first
+            argCount = 2;
+        } else if (!strcmp(*argv, "-ss")) {	// syscall statistics
+            if (syscallStats == NULL) syscallStats = new SyscallStats(MAX_SYSCALL_CODE);
+        } else if (!strcmp(*argv, "-st")) {	// syscall trace
+            ASSERT(argc > 1);
+            if (syscallStats == NULL) syscallStats = new SyscallStats(MAX_SYSCALL_CODE);
+            syscallStats->StartTrace(*(argv + 1));
+            argCount = 2;
         } else if (!strcmp(*argv, "-R")) {
 		        replacementAlgo = atoi(*(argv + 1));
 		        argCount = 2;
@@ -0,0 +1,166 @@
+// proctable.cc
+//	Routines to hand out and recycle pids.  See proctable.h.
+//
+//	As for the ready list, mutual exclusion comes from the callers:
+//	threads are only created and destroyed with no other thread
+//	running in between.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "proctable.h"
+
+//----------------------------------------------------------------------
+// InitSlots
+// 	Mark slots "from" up to "to" free, chained in order.
+//----------------------------------------------------------------------
+
+static void
+InitSlots(ProcessSlot *slots, int from, int to)
+{
+    int i;
+
+    for (i = from; i < to; i++) {
+	slots[i].thread = NULL;
+	slots[i].exited = slots[i].live = FALSE;
+	slots[i].nextFree = (i + 1 < to) ? i + 1 : -1;
+#ifdef USER_PROGRAM
+	bzero(slots[i].memStats, sizeof(slots[i].memStats));
+#endif
+    }
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::ProcessTable
+// 	Create a table with every pid free.
+//----------------------------------------------------------------------
+
+ProcessTable::ProcessTable()
+{
+    numSlots = PROC_INITIAL_SLOTS;
+    slots = new ProcessSlot[numSlots];
+    InitSlots(slots, 0, numSlots);
+    freeHead = 0;
+    freeTail = numSlots - 1;
+    numLive = 0;
+}
+
+ProcessTable::~ProcessTable()
+{
+    delete [] slots;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Grow
+// 	Double the number of slots.  Only called when no pid is free;
+//	the new slots become the free list.
+//----------------------------------------------------------------------
+
+void
+ProcessTable::Grow()
+{
+    ProcessSlot *newSlots = new ProcessSlot[2 * numSlots];
+    int i;
+
+    ASSERT(freeHead == -1);
+    for (i = 0; i < numSlots; i++) newSlots[i] = slots[i];
+    InitSlots(newSlots, numSlots, 2 * numSlots);
+    freeHead = numSlots;
+    freeTail = 2 * numSlots - 1;
+    numSlots *= 2;
+    delete [] slots;
+    slots = newSlots;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Add
+// 	Take the oldest free pid for "thread", which counts as live.
+//----------------------------------------------------------------------
+
+int
+ProcessTable::Add(Thread *thread)
+{
+    int pid;
+
+    if (freeHead == -1) Grow();
+    pid = freeHead;
+    freeHead = slots[pid].nextFree;
+    if (freeHead == -1) freeTail = -1;
+
+    slots[pid].thread = thread;
+    slots[pid].exited = FALSE;
+    slots[pid].live = TRUE;
+#ifdef USER_PROGRAM
+    bzero(slots[pid].memStats, sizeof(slots[pid].memStats));
+#endif
+    numLive++;
+    return pid;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::SetExited, ProcessTable::SetDaemon
+// 	The thread holding "pid" no longer counts as live.
+//----------------------------------------------------------------------
+
+void
+ProcessTable::SetExited(int pid)
+{
+    ASSERT((pid >= 0) && (pid < numSlots) && (slots[pid].thread != NULL));
+    slots[pid].exited = TRUE;
+    SetDaemon(pid);
+}
+
+void
+ProcessTable::SetDaemon(int pid)
+{
+    ASSERT((pid >= 0) && (pid < numSlots) && (slots[pid].thread != NULL));
+    if (slots[pid].live) {
+	slots[pid].live = FALSE;
+	numLive--;
+    }
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Remove
+// 	Free "pid" and put it at the end of the free list.  Its saved
+//	memory counters stay until the pid is handed out again.
+//----------------------------------------------------------------------
+
+void
+ProcessTable::Remove(int pid)
+{
+    SetExited(pid);
+    slots[pid].thread = NULL;
+    slots[pid].nextFree = -1;
+    if (freeTail == -1) freeHead = pid;
+    else slots[freeTail].nextFree = pid;
+    freeTail = pid;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Lookup
+//----------------------------------------------------------------------
+
+Thread *
+ProcessTable::Lookup(int pid)
+{
+    if ((pid < 0) || (pid >= numSlots) || slots[pid].exited) return NULL;
+    return slots[pid].thread;
+}
+
+#ifdef USER_PROGRAM
+//----------------------------------------------------------------------
+// ProcessTable::GetMemStats
+// 	The memory counters of "pid", filled in by SC_Exit and printed
+//	at halt.
+//----------------------------------------------------------------------
+
+int *
+ProcessTable::GetMemStats(int pid)
+{
+    ASSERT((pid >= 0) && (pid < numSlots));
+    return slots[pid].memStats;
+}
+#endif
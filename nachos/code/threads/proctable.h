@@ -0,0 +1,76 @@
+// proctable.h
+//	Data structures for the process table: which thread holds each
+//	pid, and how many threads are still live.
+//
+//	The table is an array of slots indexed by pid, which doubles when
+//	every pid is taken, so there is no fixed limit on the number of
+//	threads and finding a thread by pid is a single index.  A pid is
+//	given back when its thread is destroyed.  Free pids are handed out
+//	oldest first, so a pid is not reused sooner than necessary, and a
+//	run that never has more than PROC_INITIAL_SLOTS threads at once
+//	numbers them 0, 1, 2, ... as before.
+//
+//	NumLive counts the threads that have neither exited nor been
+//	marked as daemons, so Exit can tell in constant time whether it
+//	is the last one.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PROCTABLE_H
+#define PROCTABLE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+#ifdef USER_PROGRAM
+#include "memstat.h"
+#endif
+
+#define PROC_INITIAL_SLOTS	64
+
+class Thread;
+
+struct ProcessSlot {
+    Thread *thread;			// NULL if the pid is free
+    bool exited;			// Has called Exit (or Finish)
+    bool live;				// Counted by NumLive
+    int nextFree;			// Next pid on the free list, -1 at the end
+#ifdef USER_PROGRAM
+    int memStats[NUM_MEM_STATS];	// Memory counters saved at Exit, kept
+					// until the pid is reused
+#endif
+};
+
+class ProcessTable {
+  public:
+    ProcessTable();
+    ~ProcessTable();			// The threads are not deleted
+
+    int Add(Thread *thread);		// Give "thread" a pid
+    void Remove(int pid);		// The thread is being destroyed;
+					// its pid may be reused
+    void SetExited(int pid);		// The thread has exited
+    void SetDaemon(int pid);		// Do not count it as live
+
+    Thread *Lookup(int pid);		// The thread holding "pid", NULL if
+					// the pid is free or it has exited
+
+    int NumLive() { return numLive; }	// Threads not exited, not daemons
+    int NumSlots() { return numSlots; }	// Every pid is below this
+
+#ifdef USER_PROGRAM
+    int *GetMemStats(int pid);		// Counters saved for "pid"
+#endif
+
+  private:
+    void Grow();			// Double the slots
+
+    ProcessSlot *slots;
+    int numSlots;
+    int numLive;
+    int freeHead, freeTail;		// Free pids, oldest first; -1 if none
+};
+
+#endif // PROCTABLE_H
@@ -29,7 +29,7 @@
 
 Scheduler::Scheduler()
 { 
-    readyList = new List;
+    readyList = new ThreadQueue;
     empty_ready_queue_start_time = -1;
 } 
 
@@ -82,7 +82,7 @@ Scheduler::ReadyToRun (Thread *thread)
        stats->empty_ready_queue_time += (stats->totalTicks - empty_ready_queue_start_time);
        empty_ready_queue_start_time = -1;
     }
-    readyList->Append((void *)thread);
+    readyList->Append(thread);
 }
 
 //----------------------------------------------------------------------
@@ -97,10 +97,10 @@ Thread *
 Scheduler::FindNextToRun ()
 {
     if ((schedulingAlgo == UNIX_SCHED) || (schedulingAlgo == NON_PREEMPTIVE_SJF)){
-       return (Thread *)readyList->GetMinPriorityThread();
+       return readyList->RemoveMinPriority();
     }
     else {
-       return (Thread *)readyList->Remove();
+       return readyList->Remove();
     }
 }
 
@@ -223,10 +223,11 @@ Scheduler::SetEmptyReadyQueueStartTime (int ticks)
 void
 Scheduler::UpdateThreadPriority (void)
 {
-   unsigned i;
+   int i;
+   Thread *thread;
    int this_cpu_burst_duration = stats->totalTicks - cpu_burst_start_time;
    ASSERT(this_cpu_burst_duration > 0);
-   unsigned currentPID = currentThread->GetPID();
+   int currentPID = currentThread->GetPID();
 
    // First we update the currentThread priority
 
@@ -238,14 +239,14 @@ Scheduler::UpdateThreadPriority (void)
 
    // Update everybody else
 
-   for (i=0; i<thread_index; i++) {
-      if ((i != currentPID) && !exitThreadArray[i]) {
-         ASSERT(threadArray[i] != NULL);
-         currentThreadUsage = threadArray[i]->GetUsage();
+   for (i=0; i<processTable->NumSlots(); i++) {
+      thread = processTable->Lookup(i);
+      if ((i != currentPID) && (thread != NULL)) {
+         currentThreadUsage = thread->GetUsage();
          currentThreadUsage = currentThreadUsage >> 1;
-         currentThreadPriority = threadArray[i]->GetBasePriority() + (currentThreadUsage >> 1);
-         threadArray[i]->SetUsage(currentThreadUsage);
-         threadArray[i]->SetPriority(currentThreadPriority);
+         currentThreadPriority = thread->GetBasePriority() + (currentThreadUsage >> 1);
+         thread->SetUsage(currentThreadUsage);
+         thread->SetPriority(currentThreadPriority);
       }
    }
 }
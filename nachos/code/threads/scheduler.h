@@ -10,7 +10,7 @@
 #define SCHEDULER_H
 
 #include "copyright.h"
-#include "list.h"
+#include "threadqueue.h"
 #include "thread.h"
 
 // The following class defines the scheduler/dispatcher abstraction -- 
@@ -35,7 +35,7 @@ class Scheduler {
     void UpdateThreadPriority (void);	// Used by the UNIX scheduler
    
   private:
-    List *readyList;  		// queue of threads that are ready to run,
+    ThreadQueue *readyList;	// queue of threads that are ready to run,
 				// but not running
 
     int empty_ready_queue_start_time;
@@ -0,0 +1,107 @@
+// slab.cc
+//	Routines for fixed-size object pools.  See slab.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "slab.h"
+#include "system.h"
+
+SlabPool *SlabPool::allPools = NULL;
+
+//----------------------------------------------------------------------
+// SlabPool::SlabPool
+// 	Initialize an empty pool of "size" byte objects.  Slabs are
+//	only allocated once the first object is asked for.
+//----------------------------------------------------------------------
+
+SlabPool::SlabPool(char *debugName, int size)
+{
+    name = debugName;
+    objectSize = (size < (int)sizeof(void *)) ? (int)sizeof(void *) : size;
+    objectSize = divRoundUp(objectSize, sizeof(void *)) * sizeof(void *);
+    freeList = NULL;
+    numSlabs = numAllocs = inUse = peakInUse = 0;
+
+    nextPool = allPools;
+    allPools = this;
+}
+
+//----------------------------------------------------------------------
+// SlabPool::Grow
+// 	Allocate one more slab and put all of its objects on the free
+//	list.
+//----------------------------------------------------------------------
+
+void
+SlabPool::Grow()
+{
+    char *slab = new char[SLAB_OBJECTS * objectSize];
+    int i;
+
+    for (i = SLAB_OBJECTS - 1; i >= 0; i--) {
+	*(void **)&slab[i * objectSize] = freeList;
+	freeList = (void *)&slab[i * objectSize];
+    }
+    numSlabs++;
+}
+
+//----------------------------------------------------------------------
+// SlabPool::Alloc
+// 	Take an object off the free list, growing the pool if it is
+//	empty.
+//----------------------------------------------------------------------
+
+void *
+SlabPool::Alloc()
+{
+    void *object;
+
+    if (freeList == NULL) Grow();
+    object = freeList;
+    freeList = *(void **)object;
+
+    numAllocs++;
+    inUse++;
+    if (inUse > peakInUse) peakInUse = inUse;
+    return object;
+}
+
+//----------------------------------------------------------------------
+// SlabPool::Free
+// 	Put "object" back on the free list.  It is reused by the next
+//	Alloc, while it is likely still in the host's cache.
+//----------------------------------------------------------------------
+
+void
+SlabPool::Free(void *object)
+{
+    if (object == NULL) return;
+    ASSERT(inUse > 0);
+    *(void **)object = freeList;
+    freeList = object;
+    inUse--;
+}
+
+//----------------------------------------------------------------------
+// SlabPool::Print, SlabPool::PrintAll
+// 	Print pool usage, when the machine halts.
+//----------------------------------------------------------------------
+
+void
+SlabPool::Print()
+{
+    printf("Slab pool %s: %d byte objects, allocations %d, in use %d, peak %d, slabs %d\n",
+	name, objectSize, numAllocs, inUse, peakInUse, numSlabs);
+}
+
+void
+SlabPool::PrintAll()
+{
+    SlabPool *pool;
+
+    for (pool = allPools; pool != NULL; pool = pool->nextPool)
+	if (pool->numAllocs > 0) pool->Print();
+}
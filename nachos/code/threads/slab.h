@@ -0,0 +1,55 @@
+// slab.h
+//	Data structures for fixed-size object pools.
+//
+//	The kernel allocates some small objects at a very high rate --
+//	list elements for every ready queue insert and semaphore wait,
+//	pending interrupts for every Schedule, sleep queue nodes.  Each of
+//	these classes gets its own SlabPool through a class-specific
+//	operator new and operator delete.  A pool carves its objects out of
+//	slabs of SLAB_OBJECTS at a time, and keeps freed objects on a free
+//	list, linked through their first word, for the next allocation.
+//	Slabs are never given back; the pools only grow to the peak number
+//	of live objects.
+//
+//	No locking is needed: Nachos only switches threads or takes
+//	interrupts at well-defined points, never inside Alloc or Free.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include "copyright.h"
+#include "utility.h"
+
+#define SLAB_OBJECTS	64		// Objects per slab
+
+class SlabPool {
+  public:
+    SlabPool(char *debugName, int size);	// Pool of "size" byte objects.
+					// Pools are static objects; they
+					// are never deleted
+
+    void *Alloc();			// An uninitialized object
+    void Free(void *object);		// Give an object back
+
+    void Print();			// Usage of this pool
+    static void PrintAll();		// Usage of every pool, at halt
+
+  private:
+    void Grow();			// Add a slab to the free list
+
+    char *name;				// Class of the objects, for Print
+    int objectSize;			// Rounded up to hold the free link
+    void *freeList;			// Free objects
+    int numSlabs;
+    int numAllocs;			// Calls to Alloc so far
+    int inUse, peakInUse;		// Live objects
+
+    SlabPool *nextPool;			// Chain of all pools, for PrintAll
+    static SlabPool *allPools;
+};
+
+#endif // SLAB_H
@@ -0,0 +1,161 @@
+// stackpool.cc
+//	Routines to recycle thread execution stacks.  See stackpool.h.
+//
+//	Word 0 is the overflow end: stack[0] holds the thread's
+//	fencepost, and the canaries are the words right after it.  On
+//	the Snakes stacks grow upward, and everything is mirrored.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "stackpool.h"
+#include "system.h"
+
+// Which free list holds stacks of "size" words
+#define POOL_INDEX(size)	(((size) == StackSize) ? 0 : 1)
+
+//----------------------------------------------------------------------
+// StackPool::StackPool
+// 	Initialize an empty pool.  "useCanaries" selects fast mode:
+//	no guard pages, canary words checked at context switch instead.
+//----------------------------------------------------------------------
+
+StackPool::StackPool(bool useCanaries)
+{
+    canaries = useCanaries;
+    freeStacks[0] = freeStacks[1] = NULL;
+    numFree[0] = numFree[1] = 0;
+    numAllocs = numReused = 0;
+}
+
+//----------------------------------------------------------------------
+// StackPool::~StackPool
+// 	Give the pooled stacks back to the host.  Stacks still in use by
+//	threads are not ours to free.
+//----------------------------------------------------------------------
+
+StackPool::~StackPool()
+{
+    int *stack;
+
+    while ((stack = freeStacks[0]) != NULL) {
+	freeStacks[0] = *(int **)stack;
+	DeleteStack(stack, StackSize);
+    }
+    while ((stack = freeStacks[1]) != NULL) {
+	freeStacks[1] = *(int **)stack;
+	DeleteStack(stack, SmallStackSize);
+    }
+}
+
+//----------------------------------------------------------------------
+// StackPool::NewStack, StackPool::DeleteStack
+// 	Get a stack from the host, or give one back: with guard pages
+//	around it normally, as a plain array in fast mode.
+//----------------------------------------------------------------------
+
+int *
+StackPool::NewStack(int size)
+{
+    if (canaries) return new int[size];
+    return (int *) AllocBoundedArray(size * sizeof(int));
+}
+
+void
+StackPool::DeleteStack(int *stack, int size)
+{
+    if (canaries) delete [] stack;
+    else DeallocBoundedArray((char *) stack, size * sizeof(int));
+}
+
+//----------------------------------------------------------------------
+// StackPool::Alloc
+// 	Return a stack of "size" words, recycled if possible.  In fast
+//	mode its canaries are (re)written, since a recycled stack holds
+//	whatever its last thread left there.
+//----------------------------------------------------------------------
+
+int *
+StackPool::Alloc(int size)
+{
+    int which = POOL_INDEX(size);
+    int *stack;
+    int i;
+
+    ASSERT((size == StackSize) || (size == SmallStackSize));
+    numAllocs++;
+    if (freeStacks[which] != NULL) {
+	stack = freeStacks[which];
+	freeStacks[which] = *(int **)stack;
+	numFree[which]--;
+	numReused++;
+    }
+    else stack = NewStack(size);
+
+    if (canaries) {
+	for (i = 1; i <= STACK_CANARY_WORDS; i++)
+#ifdef HOST_SNAKE
+	    stack[size - 1 - i] = STACK_CANARY;
+#else
+	    stack[i] = STACK_CANARY;
+#endif
+    }
+    return stack;
+}
+
+//----------------------------------------------------------------------
+// StackPool::Free
+// 	Keep the stack of a destroyed thread for the next Alloc, unless
+//	there are already plenty of those.
+//----------------------------------------------------------------------
+
+void
+StackPool::Free(int *stack, int size)
+{
+    int which = POOL_INDEX(size);
+
+    if (numFree[which] == STACK_POOL_MAX) {
+	DeleteStack(stack, size);
+	return;
+    }
+    *(int **)stack = freeStacks[which];
+    freeStacks[which] = stack;
+    numFree[which]++;
+}
+
+//----------------------------------------------------------------------
+// StackPool::Overflowed
+// 	Return TRUE if the thread running on "stack" wrote past its end,
+//	as far as the canaries can tell.  Always FALSE with guard pages:
+//	the host has already caught the overflow then.
+//----------------------------------------------------------------------
+
+bool
+StackPool::Overflowed(int *stack, int size)
+{
+    int i;
+
+    if (!canaries) return FALSE;
+    for (i = 1; i <= STACK_CANARY_WORDS; i++)
+#ifdef HOST_SNAKE
+	if (stack[size - 1 - i] != (int) STACK_CANARY) return TRUE;
+#else
+	if (stack[i] != (int) STACK_CANARY) return TRUE;
+#endif
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// StackPool::Print
+// 	Print pool usage, when the machine halts.
+//----------------------------------------------------------------------
+
+void
+StackPool::Print()
+{
+    printf("Kernel stacks: %s, allocations %d, reused %d, pooled %d\n",
+	canaries ? "canaries" : "guard pages", numAllocs, numReused,
+	numFree[0] + numFree[1]);
+}
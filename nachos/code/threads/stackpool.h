@@ -0,0 +1,60 @@
+// stackpool.h
+//	Data structures for recycling thread execution stacks.
+//
+//	Allocating a stack used to cost a host allocation plus two
+//	mprotect calls for the guard pages around it (AllocBoundedArray),
+//	and freeing it two more.  Fork-heavy workloads spent most of their
+//	host time there.  Stacks of a finished thread now go back to a
+//	pool, guard pages and all, and the next Fork of the same stack size
+//	takes one from there.
+//
+//	In fast mode (-fs) stacks are plain host allocations without guard
+//	pages.  Instead the STACK_CANARY_WORDS words just past the overflow
+//	end fencepost are filled with a known pattern, and an overflow is
+//	caught at the next context switch if any of them was overwritten
+//	(see Thread::CheckOverflow).
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef STACKPOOL_H
+#define STACKPOOL_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// Stack of a kernel-only thread, which never runs user code or syscall
+// handlers (see Thread::UseSmallStack), in words
+#define SmallStackSize		(2 * 1024)
+
+#define STACK_CANARY		0xfeedface	// Fill pattern of the canaries
+#define STACK_CANARY_WORDS	16		// Canaries per stack, fast mode
+#define STACK_POOL_MAX		32		// Free stacks kept per size
+
+// The following class defines the pool of free stacks.  Only the two
+// stack sizes StackSize and SmallStackSize are used, so there is one
+// free list for each, linked through the first words of the stacks.
+
+class StackPool {
+  public:
+    StackPool(bool useCanaries);	// Guard pages unless "useCanaries"
+    ~StackPool();			// Free the pooled stacks
+
+    int *Alloc(int size);		// A stack of "size" words, canaries set
+    void Free(int *stack, int size);	// Give it back when its thread is gone
+    bool Overflowed(int *stack, int size);	// Was a canary overwritten?
+
+    void Print();			// Pool usage, at halt
+
+  private:
+    int *NewStack(int size);		// Allocate from the host
+    void DeleteStack(int *stack, int size);	// Return to the host
+
+    bool canaries;			// Fast mode
+    int *freeStacks[2];			// StackSize and SmallStackSize stacks
+    int numFree[2];
+    int numAllocs, numReused;		// Usage counters
+};
+
+#endif // STACKPOOL_H
@@ -1,8 +1,7 @@
 // synch.cc 
 //	Routines for synchronizing threads.  Three kinds of
 //	synchronization routines are defined here: semaphores, locks 
-//   	and condition variables (the implementation of the last two
-//	are left to the reader).
+//   	and condition variables.
 //
 // Any implementation of a synchronization routine needs some
 // primitive atomic operation.  We assume Nachos is running on
@@ -37,7 +36,7 @@ Semaphore::Semaphore(char* debugName, int initialValue)
 {
     name = debugName;
     value = initialValue;
-    queue = new List;
+    queue = new ThreadQueue;
 }
 
 //----------------------------------------------------------------------
@@ -79,7 +78,7 @@ Semaphore::P()
     IntStatus oldLevel = interrupt->SetLevel(IntOff);	// disable interrupts
     
     while (value == 0) { 			// semaphore not available
-	queue->Append((void *)currentThread);	// so go to sleep
+	queue->Append(currentThread);	// so go to sleep
 	currentThread->Sleep();
     } 
     value--; 					// semaphore available, 
@@ -102,32 +101,246 @@ Semaphore::V()
     Thread *thread;
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
 
-    thread = (Thread *)queue->Remove();
+    thread = queue->Remove();
     if (thread != NULL)	   // make thread ready, consuming the V immediately
 	scheduler->ReadyToRun(thread);
     value++;
     (void) interrupt->SetLevel(oldLevel);
 }
 
-// Dummy functions -- so we can compile our later assignments 
-// Note -- without a correct implementation of Condition::Wait(), 
-// the test case in the network assignment won't work!
-Lock::Lock(char* debugName) {}
-Lock::~Lock() {}
-void Lock::Acquire() {}
-void Lock::Release() {}
+// Best priority seen by NoteWaiterPriority; used by RecomputeDonation
+static int bestWaiterPriority;
 
-Condition::Condition(char* debugName) { 
+//----------------------------------------------------------------------
+// NoteWaiterPriority
+// 	Mapcar helper: remember the best (lowest) priority of the
+//	threads waiting on a lock.
+//----------------------------------------------------------------------
+
+static void
+NoteWaiterPriority(int arg)
+{
+    Thread *thread = (Thread *)arg;
+
+    if (thread->GetPriority() < bestWaiterPriority)
+	bestWaiterPriority = thread->GetPriority();
+}
+
+//----------------------------------------------------------------------
+// Lock::Lock
+// 	Initialize a lock, so that it can be used for synchronization.
+//	The lock starts out FREE.
+//
+//	"debugName" is an arbitrary name, useful for debugging.
+//----------------------------------------------------------------------
+
+Lock::Lock(char* debugName)
+{
     name = debugName;
-    //value = initialValue;
-    queue = new List;
+    holder = NULL;
+    queue = new ThreadQueue;
+    nextHeld = NULL;
+}
+
+//----------------------------------------------------------------------
+// Lock::~Lock
+// 	De-allocate a lock.  Nobody may hold it or wait for it.
+//----------------------------------------------------------------------
+
+Lock::~Lock()
+{
+    ASSERT((holder == NULL) && queue->IsEmpty());
+    delete queue;
+}
+
+//----------------------------------------------------------------------
+// Lock::isHeldByCurrentThread
+// 	Return TRUE if the current thread holds this lock.
+//----------------------------------------------------------------------
+
+bool
+Lock::isHeldByCurrentThread()
+{
+    return (holder == currentThread);
+}
+
+//----------------------------------------------------------------------
+// Lock::DonatePriority
+// 	Called by a thread about to block on this lock, under the UNIX
+//	scheduler.  Lend "donated" to the holder if it is better than
+//	the holder's own, and follow the chain of locks the holders are
+//	themselves blocked on.  The walk stops at the first thread that
+//	already runs at least this urgently, so a deadlock cycle cannot
+//	make it loop.
+//----------------------------------------------------------------------
+
+void
+Lock::DonatePriority(int donated)
+{
+    Lock *lock = this;
+
+    while ((lock != NULL) && (lock->holder != NULL) &&
+	   (donated < lock->holder->GetPriority())) {
+	DEBUG('t', "Lending priority %d to \"%s\" (holds \"%s\")\n",
+	      donated, lock->holder->getName(), lock->name);
+	lock->holder->donatedPriority = donated;
+	lock = lock->holder->blockedOn;
+    }
+}
+
+//----------------------------------------------------------------------
+// Lock::RecomputeDonation
+// 	"thread" has just released a lock: its donated priority is now
+//	the best priority among the waiters of the locks it still holds.
+//----------------------------------------------------------------------
+
+void
+Lock::RecomputeDonation(Thread *thread)
+{
+    Lock *lock;
+
+    bestWaiterPriority = NO_DONATED_PRIORITY;
+    for (lock = thread->heldLocks; lock != NULL; lock = lock->nextHeld)
+	lock->queue->Mapcar(NoteWaiterPriority);
+    thread->donatedPriority = bestWaiterPriority;
+}
+
+//----------------------------------------------------------------------
+// Lock::Acquire
+// 	Wait until the lock is FREE, then take it.  As with P(), the
+//	check and the update must be atomic, so interrupts are disabled.
+//	Locks are not recursive.
+//----------------------------------------------------------------------
+
+void
+Lock::Acquire()
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    ASSERT(!isHeldByCurrentThread());
+    while (holder != NULL) {
+	if (schedulingAlgo == UNIX_SCHED)
+	    DonatePriority(currentThread->GetPriority());
+	currentThread->blockedOn = this;
+	queue->Append(currentThread);
+	currentThread->Sleep();
+    }
+    currentThread->blockedOn = NULL;
+    holder = currentThread;
+    nextHeld = currentThread->heldLocks;
+    currentThread->heldLocks = this;
+
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Lock::Release
+// 	Set the lock FREE and wake up one waiter, which will retry the
+//	Acquire.  Under the UNIX scheduler the most urgent waiter is
+//	woken, and any priority lent through this lock is given back.
+//	Only the holder may release the lock.
+//----------------------------------------------------------------------
+
+void
+Lock::Release()
+{
+    Thread *thread;
+    Lock **link;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    ASSERT(isHeldByCurrentThread());
+    for (link = &currentThread->heldLocks; *link != this; link = &(*link)->nextHeld)
+	ASSERT(*link != NULL);
+    *link = nextHeld;
+    nextHeld = NULL;
+    holder = NULL;
+
+    if (schedulingAlgo == UNIX_SCHED) {
+	thread = queue->RemoveMinPriority();
+	RecomputeDonation(currentThread);
+    }
+    else thread = queue->Remove();
+    if (thread != NULL)
+	scheduler->ReadyToRun(thread);
+
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Condition::Condition
+// 	Initialize a condition variable with nobody waiting.
+//----------------------------------------------------------------------
+
+Condition::Condition(char* debugName)
+{
+    name = debugName;
+    queue = new ThreadQueue;
+}
+
+//----------------------------------------------------------------------
+// Condition::~Condition
+// 	De-allocate a condition variable.
+//----------------------------------------------------------------------
+
+Condition::~Condition()
+{
+    delete queue;
+}
+
+//----------------------------------------------------------------------
+// Condition::Wait
+// 	Release "conditionLock", sleep until signaled, then re-acquire
+//	the lock.  Interrupts are off from before the release until we
+//	are asleep, so a Signal cannot slip in between and be lost.
+//	Mesa semantics: the caller must re-check its condition.
+//----------------------------------------------------------------------
+
+void
+Condition::Wait(Lock* conditionLock)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    ASSERT(conditionLock->isHeldByCurrentThread());
+    queue->Append(currentThread);
+    conditionLock->Release();
+    currentThread->Sleep();
+    conditionLock->Acquire();
+
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Condition::Signal, Condition::Broadcast
+// 	Wake up one, or all, of the threads waiting on the condition.
+//	The woken threads compete for the lock like anybody else.
+//----------------------------------------------------------------------
+
+void
+Condition::Signal(Lock* conditionLock)
+{
+    Thread *thread;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    ASSERT(conditionLock->isHeldByCurrentThread());
+    thread = queue->Remove();
+    if (thread != NULL)
+	scheduler->ReadyToRun(thread);
+
+    (void) interrupt->SetLevel(oldLevel);
 }
-Condition::~Condition() {
-	delete queue;	
+
+void
+Condition::Broadcast(Lock* conditionLock)
+{
+    Thread *thread;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    ASSERT(conditionLock->isHeldByCurrentThread());
+    while ((thread = queue->Remove()) != NULL)
+	scheduler->ReadyToRun(thread);
+
+    (void) interrupt->SetLevel(oldLevel);
 }
-void Condition::Wait(Lock* conditionLock) { ASSERT(FALSE); }
-void Condition::Signal(Lock* conditionLock) { }
-void Condition::Broadcast(Lock* conditionLock) { }
 
 void
 Condition::Wait(Semaphore* S)
@@ -135,7 +348,7 @@ Condition::Wait(Semaphore* S)
 	//printf("line 1");
 	S->V();
 	//printf("line 2");
-	queue->Append((void *)currentThread);	// so go to sleep
+	queue->Append(currentThread);	// so go to sleep
 	//printf("line 3");
 	IntStatus oldLevel = interrupt->SetLevel(IntOff);
 	//printf("line 4");
@@ -154,7 +367,7 @@ Condition::Signal()
 	
 //    IntStatus oldLevel = interrupt->SetLevel(IntOff);
 
-    thread = (Thread *)queue->Remove();
+    thread = queue->Remove();
     if (thread != NULL)	   // make thread ready, consuming the V immediately
 	scheduler->ReadyToRun(thread);
     //value++;
@@ -168,11 +381,219 @@ Condition::Broadcast()
 	
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
 
-    thread = (Thread *)queue->Remove();
+    thread = queue->Remove();
     while (thread != NULL) {	   // make thread ready, consuming the V immediately
 	scheduler->ReadyToRun(thread);
-	thread = (Thread *)queue->Remove();
+	thread = queue->Remove();
     }
     //value++;
     (void) interrupt->SetLevel(oldLevel);
 }
+
+//----------------------------------------------------------------------
+// RWLock::RWLock
+// 	Initialize a reader-writer lock, nobody holding it.
+//----------------------------------------------------------------------
+
+RWLock::RWLock(char* debugName)
+{
+    name = debugName;
+    readers = 0;
+    readerCapacity = RWLOCK_INITIAL_READERS;
+    readerThreads = new Thread*[readerCapacity];
+    writer = NULL;
+    readQueue = new ThreadQueue;
+    writeQueue = new ThreadQueue;
+}
+
+//----------------------------------------------------------------------
+// RWLock::~RWLock
+// 	De-allocate a reader-writer lock, which must be FREE.
+//----------------------------------------------------------------------
+
+RWLock::~RWLock()
+{
+    ASSERT(!isBusy());
+    delete [] readerThreads;
+    delete readQueue;
+    delete writeQueue;
+}
+
+bool
+RWLock::isWriteHeldByCurrentThread()
+{
+    return (writer == currentThread);
+}
+
+bool
+RWLock::isReadHeldByCurrentThread()
+{
+    int i;
+
+    for (i = 0; i < readers; i++)
+	if (readerThreads[i] == currentThread) return TRUE;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// RWLock::AddReader
+// 	Record "thread" as holding the lock for reading, growing the
+//	array of readers if it is full.  Interrupts are off.
+//----------------------------------------------------------------------
+
+void
+RWLock::AddReader(Thread *thread)
+{
+    Thread **newThreads;
+    int i;
+
+    if (readers == readerCapacity) {
+	newThreads = new Thread*[2 * readerCapacity];
+	for (i = 0; i < readers; i++) newThreads[i] = readerThreads[i];
+	delete [] readerThreads;
+	readerThreads = newThreads;
+	readerCapacity *= 2;
+    }
+    readerThreads[readers++] = thread;
+}
+
+bool
+RWLock::isBusy()
+{
+    return ((readers > 0) || (writer != NULL) ||
+	    !readQueue->IsEmpty() || !writeQueue->IsEmpty());
+}
+
+//----------------------------------------------------------------------
+// RWLock::AcquireRead
+// 	Join the readers, unless a writer holds the lock or is waiting
+//	for it.  In that case sleep; whoever wakes us has already
+//	counted us as a reader.
+//----------------------------------------------------------------------
+
+void
+RWLock::AcquireRead()
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    ASSERT(writer != currentThread);
+    if ((writer == NULL) && writeQueue->IsEmpty())
+	AddReader(currentThread);
+    else {
+	readQueue->Append(currentThread);
+	currentThread->Sleep();
+    }
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// RWLock::AcquireWrite
+// 	Take the lock if nobody holds it, else sleep until it is handed
+//	to us.
+//----------------------------------------------------------------------
+
+void
+RWLock::AcquireWrite()
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    ASSERT(writer != currentThread);
+    if ((writer == NULL) && (readers == 0))
+	writer = currentThread;
+    else {
+	writeQueue->Append(currentThread);
+	currentThread->Sleep();
+	ASSERT(writer == currentThread);
+    }
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// RWLock::Release
+// 	Give up our access.  A leaving writer hands the lock to every
+//	waiting reader, or if there are none to the next writer; the
+//	last leaving reader hands it to the next writer.  The caller
+//	must hold the lock, as the writer or as one of the readers.
+//----------------------------------------------------------------------
+
+void
+RWLock::Release()
+{
+    Thread *thread;
+    int i;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    if (writer == currentThread) {
+	writer = NULL;
+	while ((thread = readQueue->Remove()) != NULL) {
+	    AddReader(thread);
+	    scheduler->ReadyToRun(thread);
+	}
+    }
+    else {
+	for (i = 0; (i < readers) && (readerThreads[i] != currentThread); i++)
+	    ;
+	ASSERT(i < readers);		// neither the writer nor a reader
+	readerThreads[i] = readerThreads[--readers];
+    }
+    if ((writer == NULL) && (readers == 0)) {
+	thread = writeQueue->Remove();
+	if (thread != NULL) {
+	    writer = thread;
+	    scheduler->ReadyToRun(thread);
+	}
+    }
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Barrier::Barrier
+// 	Initialize a barrier for rounds of "count" threads.
+//----------------------------------------------------------------------
+
+Barrier::Barrier(char* debugName, int numThreads)
+{
+    ASSERT(numThreads > 0);
+    name = debugName;
+    count = numThreads;
+    arrived = 0;
+    queue = new ThreadQueue;
+}
+
+//----------------------------------------------------------------------
+// Barrier::~Barrier
+// 	De-allocate a barrier.  Nobody may be waiting on it.
+//----------------------------------------------------------------------
+
+Barrier::~Barrier()
+{
+    ASSERT(arrived == 0);
+    delete queue;
+}
+
+//----------------------------------------------------------------------
+// Barrier::Wait
+// 	Block until "count" threads have arrived.  The last one to arrive
+//	makes all the others ready in one go, starts the next round, and
+//	returns TRUE without blocking; the others return FALSE.
+//----------------------------------------------------------------------
+
+bool
+Barrier::Wait()
+{
+    Thread *thread;
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    if (arrived == count - 1) {
+	arrived = 0;
+	while ((thread = queue->Remove()) != NULL)
+	    scheduler->ReadyToRun(thread);
+	(void) interrupt->SetLevel(oldLevel);
+	return TRUE;
+    }
+    arrived++;
+    queue->Append(currentThread);
+    currentThread->Sleep();
+    (void) interrupt->SetLevel(oldLevel);
+    return FALSE;
+}
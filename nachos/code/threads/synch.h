@@ -1,11 +1,8 @@
 // synch.h 
 //	Data structures for synchronizing threads.
 //
-//	Three kinds of synchronization are defined here: semaphores,
-//	locks, and condition variables.  The implementation for
-//	semaphores is given; for the latter two, only the procedure
-//	interface is given -- they are to be implemented as part of 
-//	the first assignment.
+//	The synchronization objects defined here are semaphores, locks,
+//	condition variables, reader-writer locks and barriers.
 //
 //	Note that all the synchronization objects take a "name" as
 //	part of the initialization.  This is solely for debugging purposes.
@@ -19,7 +16,7 @@
 
 #include "copyright.h"
 #include "thread.h"
-#include "list.h"
+#include "threadqueue.h"
 #include "synchop.h"
 
 // The following class defines a "semaphore" whose value is a non-negative
@@ -51,7 +48,7 @@ class Semaphore {
   private:
     char* name;        // useful for debugging
     int value;         // semaphore value, always >= 0
-    List *queue;       // threads waiting in P() for the value to be > 0
+    ThreadQueue *queue; // threads waiting in P() for the value to be > 0
 };
 
 // The following class defines a "lock".  A lock can be BUSY or FREE.
@@ -65,6 +62,11 @@ class Semaphore {
 // In addition, by convention, only the thread that acquired the lock
 // may release it.  As with semaphores, you can't read the lock value
 // (because the value might change immediately after you read it).  
+//
+// Under the UNIX scheduler a thread that blocks in Acquire lends its
+// priority to the holder (and on to whatever lock the holder is blocked
+// on), so that a low-priority holder cannot be starved by threads of
+// middle priority.  The loan is taken back in Release.
 
 class Lock {
   public:
@@ -81,8 +83,13 @@ class Lock {
 					// Condition variable ops below.
 
   private:
+    void DonatePriority(int donated);	// Boost the chain of holders
+    void RecomputeDonation(Thread *thread);	// After "thread" released a lock
+
     char* name;				// for debugging
-    // plus some other stuff you'll need to define
+    Thread *holder;			// NULL if the lock is FREE
+    ThreadQueue *queue;		// threads waiting in Acquire
+    Lock *nextHeld;			// next lock held by "holder"
 };
 
 // The following class defines a "condition variable".  A condition
@@ -136,7 +143,72 @@ class Condition {
 	void Broadcast();
   private:
     char* name;
-	List *queue;
-    // plus some other stuff you'll need to define
+    ThreadQueue *queue;		// threads waiting in either form of Wait
+};
+// The following class defines a "reader-writer lock".  Any number of
+// readers may hold it at the same time, or else a single writer:
+//
+//	AcquireRead -- wait until no writer holds or waits for the lock
+//
+//	AcquireWrite -- wait until nobody holds the lock
+//
+//	Release -- give up whichever access the caller holds; only a
+//	reader or the writer may release
+//
+// Waiters are handed the lock directly when it is released, instead of
+// being woken to compete for it.  A writer that leaves hands the lock to
+// *all* waiting readers at once, if there are any; the last reader to
+// leave hands it to one waiting writer.  New readers queue behind a
+// waiting writer, so neither side can starve the other.
+
+#define RWLOCK_INITIAL_READERS	4	// Reader slots before growing
+
+class RWLock {
+  public:
+    RWLock(char* debugName);		// initialize lock to be FREE
+    ~RWLock();				// deallocate lock; must be FREE
+    char* getName() { return name; }	// debugging assist
+
+    void AcquireRead();
+    void AcquireWrite();
+    void Release();
+
+    bool isWriteHeldByCurrentThread();	// true if we hold it as writer
+    bool isReadHeldByCurrentThread();	// true if we are one of the readers
+    int getReaders() { return readers; }	// readers holding the lock
+    bool isBusy();			// held or waited for
+
+  private:
+    void AddReader(Thread *thread);	// Count "thread" as a reader
+
+    char* name;				// for debugging
+    int readers;			// readers holding the lock
+    Thread **readerThreads;		// who they are, once per AcquireRead
+    int readerCapacity;			// size of readerThreads
+    Thread *writer;			// writer holding the lock, or NULL
+    ThreadQueue *readQueue;		// threads waiting in AcquireRead
+    ThreadQueue *writeQueue;		// threads waiting in AcquireWrite
+};
+
+// The following class defines a "barrier" for a fixed number of
+// threads.  Wait() blocks until "count" threads have called it, then
+// releases all of them together; the barrier is then ready for the
+// next round.
+
+class Barrier {
+  public:
+    Barrier(char* debugName, int count);	// "count" threads per round
+    ~Barrier();				// deallocate; nobody may be waiting
+    char* getName() { return name; }	// debugging assist
+
+    bool Wait();			// TRUE in the thread that arrived last
+    int getCount() { return count; }
+    int getWaiting() { return arrived; }	// threads blocked in this round
+
+  private:
+    char* name;				// for debugging
+    int count;				// threads per round
+    int arrived;			// threads blocked in this round
+    ThreadQueue *queue;		// those threads
 };
 #endif // SYNCH_H
@@ -11,4 +11,9 @@
 #define COND_OP_SIGNAL		1
 #define COND_OP_BROADCAST	2
 
+// Reader-writer lock ops
+#define RWLOCK_OP_READ		0
+#define RWLOCK_OP_WRITE		1
+#define RWLOCK_OP_UNLOCK	2
+
 #endif
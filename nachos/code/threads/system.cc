@@ -8,6 +8,7 @@
 #include "copyright.h"
 #include "system.h"
 #include "machine.h"
+#include "slab.h"
 
 // This defines *all* of the global data structures used by Nachos.
 // These are all initialized and de-allocated by this file.
@@ -19,37 +20,21 @@ Interrupt *interrupt;			// interrupt status
 Statistics *stats;			// performance metrics
 Timer *timer;				// the hardware timer device,
 					// for invoking context switches
+StackPool *stackPool;			// thread stacks, -fs for canaries
 
-/*
-* For the Semaphores
-*/
-unsigned Sem_size = 0;
-int Id_counter = 0;
-int semaphoreId[MAX_SEMAPHORES];
-int semaphoreKey[MAX_SEMAPHORES];
-Semaphore *semaphores[MAX_SEMAPHORES];
-/*
-* For Condition Variable
-*/
-unsigned Cond_size = 0;
-int CondId_counter = 0;
-int conditionId[MAX_CONDITIONS];
-int conditionKey[MAX_CONDITIONS];
-Condition *conditions[MAX_CONDITIONS];
-//////////////
 /*For Demand Pagin */
-bool PhyPageIsAllocated[NumPhysPages]={false};	//tells if a physical page is free or allocated
-char *currentFile;
+int PageSize = DEFAULT_PAGE_SIZE;		// memory geometry, see machine.h
+int NumPhysPages = DEFAULT_NUM_PHYS_PAGES;
+bool *PhyPageIsAllocated;	//tells if a physical page is free or allocated
 int replacementAlgo = 0;
 int PageReplacement();
+/* For same-page merging */
+int *frameCowCount;	// copy-on-write mappings of a merged frame, 0 for private frames
 
 ///////////////
 unsigned numPagesAllocated;              // number of physical frames allocated
 
-Thread *threadArray[MAX_THREAD_COUNT];  // Array of thread pointers
-unsigned thread_index;			// Index into this array (also used to assign unique pid)
-bool initializedConsoleSemaphores;
-bool exitThreadArray[MAX_THREAD_COUNT];  //Marks exited threads
+ProcessTable *processTable;		// pids, recycled as threads are destroyed
 
 TimeSortedWaitQueue *sleepQueueHead;	// Needed to implement SC_Sleep
 
@@ -58,7 +43,6 @@ char **batchProcesses;			// Names of batch processes
 int *priority;				// Process priority
 
 int cpu_burst_start_time;        // Records the start of current CPU burst
-int completionTimeArray[MAX_THREAD_COUNT];        // Records the completion time of all simulated threads
 bool excludeMainThread;		// Used by completion time statistics calculation
 
 #ifdef FILESYS_NEEDED
@@ -71,6 +55,22 @@ SynchDisk   *synchDisk;
 
 #ifdef USER_PROGRAM	// requires either FILESYS or FILESYS_STUB
 Machine *machine;	// user program memory and registers
+BufferedConsole *kernelConsole;		// console output of user programs
+
+AddrSpace **frameSpace;			// frame table, NumPhysPages entries
+unsigned *frameVpn;
+int *frameLoadTime;
+int *frameLastUse;
+CompressedPool *compressedPool;		// compressed swap tier
+SyscallStats *syscallStats;		// syscall counters, -ss and -st
+IpcTable *semaphoreTable;		// SemGet/SemOp/SemCtl objects
+IpcTable *conditionTable;		// CondGet/CondOp/CondRemove objects
+IpcTable *semSetTable;			// SemSetGet/SemOpMulti/SemSetCtl sets
+IpcTable *rwLockTable;			// RWLockGet/RWLockOp/RWLockRemove objects
+IpcTable *barrierTable;			// BarrierGet/BarrierWait/BarrierRemove objects
+IpcTable *msgQueueTable;		// MsgQueueGet/MsgSend/MsgReceive queues
+
+int defaultResidentLimit;		// per-process resident-set limit
 #endif
 
 #ifdef NETWORK
@@ -81,6 +81,27 @@ PostOffice *postOffice;
 // External definition, to allow us to take a pointer to this function
 extern void Cleanup();
 
+// Sleep, WaitForSwapIO and the daemons allocate one node per nap
+static SlabPool sleepQueuePool("TimeSortedWaitQueue", sizeof(TimeSortedWaitQueue));
+
+//----------------------------------------------------------------------
+// TimeSortedWaitQueue::operator new, TimeSortedWaitQueue::operator delete
+// 	Sleep queue nodes are recycled through sleepQueuePool.
+//----------------------------------------------------------------------
+
+void *
+TimeSortedWaitQueue::operator new(size_t size)
+{
+    ASSERT(size == sizeof(TimeSortedWaitQueue));
+    return sleepQueuePool.Alloc();
+}
+
+void
+TimeSortedWaitQueue::operator delete(void *p)
+{
+    sleepQueuePool.Free(p);
+}
+
 
 //----------------------------------------------------------------------
 // TimerInterruptHandler
@@ -137,8 +158,8 @@ Initialize(int argc, char **argv)
     int argCount, i;
     char* debugArgs = "";
     bool randomYield = FALSE;
+    bool fastStacks = FALSE;
 
-    initializedConsoleSemaphores = false;
     numPagesAllocated = 0;
 
     schedulingAlgo = NON_PREEMPTIVE_BASE;	// Default
@@ -155,8 +176,7 @@ Initialize(int argc, char **argv)
     
     excludeMainThread = FALSE;
 
-    for (i=0; i<MAX_THREAD_COUNT; i++) { threadArray[i] = NULL; exitThreadArray[i] = false; completionTimeArray[i] = -1; }
-    thread_index = 0;
+    processTable = new ProcessTable;
 
     sleepQueueHead = NULL;
 
@@ -186,10 +206,23 @@ Initialize(int argc, char **argv)
 						// number generator
 	    randomYield = TRUE;
 	    argCount = 2;
+	} else if (!strcmp(*argv, "-fs")) {
+	    fastStacks = TRUE;		// canaries instead of guard pages
 	}
 #ifdef USER_PROGRAM
 	if (!strcmp(*argv, "-s"))
 	    debugUserProg = TRUE;
+	else if (!strcmp(*argv, "-np")) {	// number of physical frames
+	    ASSERT(argc > 1);
+	    NumPhysPages = atoi(*(argv + 1));
+	    ASSERT(NumPhysPages > 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-ps")) {	// page size in bytes
+	    ASSERT(argc > 1);
+	    PageSize = atoi(*(argv + 1));
+	    ASSERT((PageSize > 0) && ((PageSize % 4) == 0));
+	    argCount = 2;
+	}
 #endif
 #ifdef FILESYS_NEEDED
 	if (!strcmp(*argv, "-f"))
@@ -212,6 +245,7 @@ Initialize(int argc, char **argv)
     stats = new Statistics();			// collect statistics
     interrupt = new Interrupt;			// start up interrupt handling
     scheduler = new Scheduler();		// initialize the ready queue
+    stackPool = new StackPool(fastStacks);	// before any Fork
     //if (randomYield)				// start the timer (if needed)
        timer = new Timer(TimerInterruptHandler, 0, randomYield);
 
@@ -231,6 +265,29 @@ Initialize(int argc, char **argv)
     
 #ifdef USER_PROGRAM
     machine = new Machine(debugUserProg);	// this must come first
+
+    PhyPageIsAllocated = new bool[NumPhysPages];
+    frameCowCount = new int[NumPhysPages];
+    frameSpace = new AddrSpace*[NumPhysPages];
+    frameVpn = new unsigned[NumPhysPages];
+    frameLoadTime = new int[NumPhysPages];
+    frameLastUse = new int[NumPhysPages];
+    for (i=0; i<NumPhysPages; i++) {
+       PhyPageIsAllocated[i] = FALSE;
+       frameCowCount[i] = 0;
+       frameSpace[i] = NULL;
+    }
+    compressedPool = NULL;
+    syscallStats = NULL;
+    defaultResidentLimit = 0;
+    kernelConsole = new BufferedConsole(CONSOLE_BUFFER_SIZE);
+    semaphoreTable = new IpcTable;
+    conditionTable = new IpcTable;
+    semSetTable = new IpcTable;
+    rwLockTable = new IpcTable;
+    barrierTable = new IpcTable;
+    msgQueueTable = new IpcTable;
+    InitializeSyscalls();
 #endif
 
 #ifdef FILESYS
@@ -259,7 +316,22 @@ Cleanup()
 #endif
     
 #ifdef USER_PROGRAM
+    delete kernelConsole;			// writes out buffered output
     delete machine;
+    if (compressedPool != NULL) delete compressedPool;
+    if (syscallStats != NULL) delete syscallStats;	// closes the trace
+    delete semaphoreTable;
+    delete conditionTable;
+    delete semSetTable;
+    delete rwLockTable;
+    delete barrierTable;
+    delete msgQueueTable;
+    delete [] PhyPageIsAllocated;
+    delete [] frameCowCount;
+    delete [] frameSpace;
+    delete [] frameVpn;
+    delete [] frameLoadTime;
+    delete [] frameLastUse;
 #endif
 
 #ifdef FILESYS_NEEDED
@@ -272,6 +344,8 @@ Cleanup()
     
     delete timer;
     delete scheduler;
+    delete stackPool;
+    delete processTable;
     delete interrupt;
     
     Exit(0);
@@ -16,8 +16,9 @@
 #include "stats.h"
 #include "timer.h"
 #include "synch.h"
+#include "stackpool.h"
+#include "proctable.h"
 
-#define MAX_THREAD_COUNT 1000
 #define MAX_BATCH_SIZE 100
 
 // Scheduling algorithms
@@ -36,8 +37,11 @@
 #define DEFAULT_BASE_PRIORITY	50		// Default base priority (used by UNIX scheduler)
 #define GET_NICE_FROM_PARENT	-1
 
-#define MAX_SEMAPHORES		128
-#define MAX_CONDITIONS		128
+// Page replacement algorithms
+#define RANDOM_REPLACEMENT	1
+#define FIFO_REPLACEMENT	2
+#define LRU_REPLACEMENT		3
+#define CLOCK_REPLACEMENT	4
 
 // Initialization and cleanup routines
 extern void Initialize(int argc, char **argv); 	// Initialization,
@@ -51,39 +55,25 @@ extern Scheduler *scheduler;			// the ready list
 extern Interrupt *interrupt;			// interrupt status
 extern Statistics *stats;			// performance metrics
 extern Timer *timer;				// the hardware alarm clock
+extern StackPool *stackPool;			// recycled thread stacks
 extern unsigned numPagesAllocated;		// number of physical frames allocated
 
-extern Thread *threadArray[];  // Array of thread pointers
-extern unsigned thread_index;                  // Index into this array (also used to assign unique pid)
-extern bool initializedConsoleSemaphores;	// Used to initialize the semaphores for console I/O exactly once
-extern bool exitThreadArray[];		// Marks exited threads
+extern ProcessTable *processTable;	// Thread of each pid, live count
 
 extern int schedulingAlgo;		// Scheduling algorithm to simulate
 extern char **batchProcesses;		// Names of batch executables
 extern int *priority;			// Process priority
 
 extern int cpu_burst_start_time;	// Records the start of current CPU burst
-extern int completionTimeArray[];	// Records the completion time of all simulated threads
 extern bool excludeMainThread;		// Used by completion time statistics calculation
 
-//////Semaphore ke liye
-extern int Id_counter;
-extern unsigned Sem_size;
-extern int semaphoreId[];
-extern int semaphoreKey[];
-extern Semaphore *semaphores[];
-//////Condition Variables ke liye
-extern unsigned Cond_size;
-extern int CondId_counter;
-extern int conditionId[];
-extern int conditionKey[];
-extern Condition *conditions[];
-//////
 /*for demand paging*/
-extern bool PhyPageIsAllocated[];
-extern char *currentFile;
+extern bool *PhyPageIsAllocated;	// NumPhysPages entries, see Initialize
 extern int replacementAlgo;
 extern int PageReplacement();
+extern int FindFreeFrame();
+/* for same-page merging */
+extern int *frameCowCount;		// Number of copy-on-write mappings of each frame
 
 /////
 class TimeSortedWaitQueue {		// Needed to implement SC_Sleep
@@ -95,6 +85,9 @@ private:
 public:
    TimeSortedWaitQueue (Thread *th,unsigned w) { t = th; when = w; next = NULL; }
    ~TimeSortedWaitQueue (void) {}
+
+   void *operator new(size_t size);	// Allocated from a SlabPool
+   void operator delete(void *p);	// (see slab.h)
    
    Thread *GetThread (void) { return t; }
    unsigned GetWhen (void) { return when; }
@@ -106,7 +99,32 @@ extern TimeSortedWaitQueue *sleepQueueHead;
 
 #ifdef USER_PROGRAM
 #include "machine.h"
+#include "swap.h"
+#include "bufconsole.h"
+#include "syscallstats.h"
+#include "ipctable.h"
 extern Machine* machine;	// user program memory and registers
+extern BufferedConsole *kernelConsole;	// Console used by user programs
+extern void InitializeSyscalls();	// Build the syscall table (exception.cc)
+
+/* frame table, for page replacement */
+extern AddrSpace **frameSpace;		// Address space whose page is in the frame,
+					// NULL if the frame must not be replaced
+extern unsigned *frameVpn;		// Virtual page held by the frame
+extern int *frameLoadTime;		// When the page was brought in (FIFO)
+extern int *frameLastUse;		// Last reference to the page (LRU)
+extern CompressedPool *compressedPool;	// Compressed swap tier, NULL if disabled
+
+extern SyscallStats *syscallStats;	// Per-call counters and trace, NULL
+					// if disabled
+extern IpcTable *semaphoreTable;	// Semaphores of user programs, by key
+extern IpcTable *conditionTable;	// and id; see ipctable.h
+extern IpcTable *semSetTable;		// Semaphore sets of user programs
+extern IpcTable *rwLockTable;		// Reader-writer locks of user programs
+extern IpcTable *barrierTable;		// Barriers of user programs
+extern IpcTable *msgQueueTable;		// Message queues of user programs
+extern int defaultResidentLimit;	// Resident-set limit of new processes,
+					// 0 for none
 #endif
 
 #ifdef FILESYS_NEEDED 		// FILESYS or FILESYS_STUB 
@@ -33,22 +33,20 @@
 
 Thread::Thread(char* threadName, int nice)
 {
-    int i;
-
     name = new char[1024];
     sprintf(name,"%s",threadName);
     stackTop = NULL;
     stack = NULL;
+    stackSize = StackSize;
     status = JUST_CREATED;
 #ifdef USER_PROGRAM
     space = NULL;
+    openFiles = NULL;
+    ring = NULL;
 #endif
 
-    threadArray[thread_index] = this;
-    pid = thread_index;
-    thread_index++;
-    stats->numTotalThreads = thread_index;
-    ASSERT(thread_index < MAX_THREAD_COUNT);
+    pid = processTable->Add(this);		// possibly a recycled pid
+    stats->numTotalThreads++;
     if (currentThread != NULL) {
        ppid = currentThread->GetPID();
        currentThread->RegisterNewChild (pid);
@@ -56,11 +54,21 @@ Thread::Thread(char* threadName, int nice)
     else ppid = -1;
 
     childcount = 0;
+    childCapacity = INITIAL_CHILD_COUNT;
+    childpidArray = new int[childCapacity];
+    childexitcode = new int[childCapacity];
+    exitedChild = new bool[childCapacity];
     waitchild_id = -1;
 
-    for (i=0; i<MAX_CHILD_COUNT; i++) exitedChild[i] = false;
-
     instructionCount = 0;
+    daemon = FALSE;
+
+    donatedPriority = NO_DONATED_PRIORITY;
+    heldLocks = NULL;
+    blockedOn = NULL;
+
+    queueNext = queuePrev = NULL;
+    queue = NULL;
     
     if (nice == GET_NICE_FROM_PARENT) {
        if (ppid != -1) {
@@ -89,15 +97,37 @@ Thread::Thread(char* threadName, int nice)
 //      NOTE: if this is the main thread, we can't delete the stack
 //      because we didn't allocate it -- we got it automatically
 //      as part of starting up Nachos.
+//
+//	Our pid is given back here and may be reused from now on, so
+//	children still running stop naming us as their parent.
 //----------------------------------------------------------------------
 
 Thread::~Thread()
 {
+    Thread *child;
+    unsigned i;
+
     DEBUG('t', "Deleting thread \"%s\"\n", name);
 
     ASSERT(this != currentThread);
+    ASSERT(queue == NULL);
+    for (i=0; i<childcount; i++) {
+       if (exitedChild[i]) continue;
+       child = processTable->Lookup(childpidArray[i]);
+       if ((child != NULL) && (child->ppid == pid)) child->ppid = -1;
+    }
+    processTable->Remove(pid);
+
     if (stack != NULL)
-	DeallocBoundedArray((char *) stack, StackSize * sizeof(int));
+	stackPool->Free(stack, stackSize);	// for the next Fork
+#ifdef USER_PROGRAM
+    if (space != NULL) delete space;	// frames were released by Exit;
+					// this drops the executable image
+#endif
+    delete [] childpidArray;
+    delete [] childexitcode;
+    delete [] exitedChild;
+    delete [] name;
 }
 
 //----------------------------------------------------------------------
@@ -152,12 +182,28 @@ Thread::Fork(VoidFunctionPtr func, int arg)
 void
 Thread::CheckOverflow()
 {
-    if (stack != NULL)
+    if (stack != NULL) {
 #ifdef HOST_SNAKE			// Stacks grow upward on the Snakes
-	ASSERT(stack[StackSize - 1] == STACK_FENCEPOST);
+	ASSERT(stack[stackSize - 1] == STACK_FENCEPOST);
 #else
 	ASSERT(*stack == STACK_FENCEPOST);
 #endif
+	ASSERT(!stackPool->Overflowed(stack, stackSize));	// -fs canaries
+    }
+}
+
+//----------------------------------------------------------------------
+// Thread::UseSmallStack
+// 	Give the thread a SmallStackSize stack when it is forked.  Only
+//	for threads that never run user programs or syscall handlers,
+//	which need the full StackSize.
+//----------------------------------------------------------------------
+
+void
+Thread::UseSmallStack()
+{
+    ASSERT(stack == NULL);
+    stackSize = SmallStackSize;
 }
 
 //----------------------------------------------------------------------
@@ -189,6 +235,61 @@ Thread::Finish ()
     // not reached
 }
 
+//----------------------------------------------------------------------
+// Thread::RegisterNewChild
+//      Called when a child is created by this thread.  If "childpid"
+//	was held by an earlier child (pids are recycled), that entry now
+//	stands for the new child; otherwise the arrays grow as needed.
+//----------------------------------------------------------------------
+
+void
+Thread::RegisterNewChild (int childpid)
+{
+   unsigned i;
+   int *newpids, *newcodes;
+   bool *newexited;
+
+   for (i=0; i<childcount; i++) {
+      if (childpid == childpidArray[i]) break;
+   }
+
+   if (i == childcount) {
+      if (childcount == childCapacity) {
+         newpids = new int[2 * childCapacity];
+         newcodes = new int[2 * childCapacity];
+         newexited = new bool[2 * childCapacity];
+         for (i=0; i<childcount; i++) {
+            newpids[i] = childpidArray[i];
+            newcodes[i] = childexitcode[i];
+            newexited[i] = exitedChild[i];
+         }
+         delete [] childpidArray;
+         delete [] childexitcode;
+         delete [] exitedChild;
+         childpidArray = newpids;
+         childexitcode = newcodes;
+         exitedChild = newexited;
+         childCapacity *= 2;
+      }
+      childcount++;
+   }
+   childpidArray[i] = childpid;
+   exitedChild[i] = false;
+}
+
+//----------------------------------------------------------------------
+// Thread::SetDaemon
+//      Mark a kernel service thread, which is not counted when
+//	deciding if all threads have exited.
+//----------------------------------------------------------------------
+
+void
+Thread::SetDaemon (void)
+{
+   daemon = TRUE;
+   processTable->SetDaemon(pid);
+}
+
 //----------------------------------------------------------------------
 // Thread::SetChildExitCode
 //      Called by an exiting thread on parent's thread object.
@@ -234,7 +335,7 @@ Thread::Exit (bool terminateSim, int exitcode)
 
     threadToBeDestroyed = currentThread;
 
-    Thread *nextThread;
+    Thread *nextThread, *parent;
 
     if (status == RUNNING) {
        stats->cpu_time += (stats->totalTicks - cpu_burst_start_time);
@@ -257,14 +358,18 @@ Thread::Exit (bool terminateSim, int exitcode)
        }
     }
     status = BLOCKED;
-    completionTimeArray[currentThread->GetPID()] = stats->totalTicks;
+    if ((stack != NULL) || !excludeMainThread) {	// the main thread has no
+       stats->numCompletedThreads++;			// stack of its own
+       stats->totalCompletionTime += stats->totalTicks;
+       stats->sumSquaredCompletion += (double)stats->totalTicks * stats->totalTicks;
+       if (stats->totalTicks > stats->maxCompletionTime) stats->maxCompletionTime = stats->totalTicks;
+       if (stats->totalTicks < stats->minCompletionTime) stats->minCompletionTime = stats->totalTicks;
+    }
 
     // Set exit code in parent's structure provided the parent hasn't exited
     if (ppid != -1) {
-       if (!exitThreadArray[ppid]) {
-          ASSERT(threadArray[ppid] != NULL);
-          threadArray[ppid]->SetChildExitCode (pid, exitcode);
-       }
+       parent = processTable->Lookup(ppid);
+       if (parent != NULL) parent->SetChildExitCode (pid, exitcode);
     }
 
     nextThread = scheduler->FindNextToRun();
@@ -431,19 +536,19 @@ void ThreadPrint(int arg){ Thread *t = (Thread *)arg; t->Print(); }
 void
 Thread::StackAllocate (VoidFunctionPtr func, int arg)
 {
-    stack = (int *) AllocBoundedArray(StackSize * sizeof(int));
+    stack = stackPool->Alloc(stackSize);	// recycled if possible
 
 #ifdef HOST_SNAKE
     // HP stack works from low addresses to high addresses
     stackTop = stack + 16;	// HP requires 64-byte frame marker
-    stack[StackSize - 1] = STACK_FENCEPOST;
+    stack[stackSize - 1] = STACK_FENCEPOST;
 #else
     // i386 & MIPS & SPARC stack works from high addresses to low addresses
 #ifdef HOST_SPARC
     // SPARC stack must contains at least 1 activation record to start with.
-    stackTop = stack + StackSize - 96;
+    stackTop = stack + stackSize - 96;
 #else  // HOST_MIPS  || HOST_i386
-    stackTop = stack + StackSize - 4;	// -4 to be on the safe side!
+    stackTop = stack + stackSize - 4;	// -4 to be on the safe side!
 #ifdef HOST_i386
     // the 80386 passes the return address on the stack.  In order for
     // SWITCH() to go to ThreadRoot when we switch to this thread, the
@@ -472,6 +577,9 @@ Thread::StackAllocate (VoidFunctionPtr func, int arg)
 //	Note that a user program thread has *two* sets of CPU registers -- 
 //	one for its state while executing user code, one for its state 
 //	while executing kernel code.  This routine saves the former.
+//	A thread stopped inside its restartable atomic sequence is saved
+//	as if it had not started it yet, and any LL reservation is lost,
+//	so that its next SC fails.
 //----------------------------------------------------------------------
 
 void
@@ -479,6 +587,8 @@ Thread::SaveUserState()
 {
     for (int i = 0; i < NumTotalRegs; i++)
 	userRegisters[i] = machine->ReadRegister(i);
+    if (space != NULL) space->RestartAtomicRegion(userRegisters);
+    machine->ClearLink();
 }
 
 //----------------------------------------------------------------------
@@ -693,7 +803,7 @@ Thread::SetPriority (int p)
 int 
 Thread::GetPriority (void)
 {
-   return schedPriority;
+   return (donatedPriority < schedPriority) ? donatedPriority : schedPriority;
 }
 
 void 
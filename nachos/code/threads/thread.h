@@ -37,14 +37,20 @@
 #ifndef THREAD_H
 #define THREAD_H
 
-#define MAX_CHILD_COUNT 100
+#define INITIAL_CHILD_COUNT 8	// Child arrays double from here
 
 #include "copyright.h"
 #include "utility.h"
 
+class Lock;
+class ThreadQueue;
+
 #ifdef USER_PROGRAM
 #include "machine.h"
 #include "addrspace.h"
+#include "fdtable.h"
+
+class AsyncRing;
 #endif
 
 // CPU register state to be saved on context switch.  
@@ -57,6 +63,9 @@
 // WATCH OUT IF THIS ISN'T BIG ENOUGH!!!!!
 #define StackSize	(4 * 1024)	// in words
 
+// Value of donatedPriority when nobody waits on a lock we hold
+#define NO_DONATED_PRIORITY	0x7fffffff
+
 
 // Thread state
 enum ThreadStatus { JUST_CREATED, RUNNING, READY, BLOCKED };
@@ -122,11 +131,14 @@ class Thread {
 
     int JoinWithChild (int whichchild);			// Called by SC_Join
 
-    void RegisterNewChild (int childpid) { childpidArray[childcount] = childpid; childcount++; ASSERT(childcount < MAX_CHILD_COUNT); }
+    void RegisterNewChild (int childpid);		// Called when a child is created
 
     void ResetReturnValue ();				// Used by SC_Fork to set the return value of child to zero
     void Schedule ();					// Called by SC_Fork to enqueue the newly created child thread in the ready queue
 
+    void UseSmallStack (void);				// Fork on a SmallStackSize stack; only for
+							// kernel-only threads (see stackpool.h)
+
     void StackAllocate(VoidFunctionPtr func, int arg);  // Allocate a stack for the simulated thread context. The thread starts execution at
                                                         // func (in kernel space) with input argument arg.
 
@@ -147,27 +159,35 @@ class Thread {
     int GetBasePriority (void);
 
     void SetPriority (int p);
-    int GetPriority (void);
+    int GetPriority (void);			// Including any donated priority
 
     void SetUsage (int usage);
     int GetUsage (void);
 
+    ThreadQueue *GetQueue (void) { return queue; }	// Ready list or wait queue
+							// we are on, NULL if none
+
+    void SetDaemon (void);			// Kernel service thread, never calls Exit
+    bool IsDaemon (void) { return daemon; }
+
   private:
     // some of the private data for this class is listed above
     
     int* stack; 	 		// Bottom of the stack 
 					// NULL if this is the main thread
 					// (If NULL, don't deallocate stack)
+    int stackSize;			// In words, StackSize unless small
     ThreadStatus status;		// ready, running or blocked
     
     char* name;
 
     int pid, ppid;			// My pid and my parent's pid
 
-    int childpidArray[MAX_CHILD_COUNT];	// My children
-    int childexitcode[MAX_CHILD_COUNT];	// Exit code of my children (return values for Join calls)
-    bool exitedChild[MAX_CHILD_COUNT];	// Which children have exited?
+    int *childpidArray;			// My children
+    int *childexitcode;			// Exit code of my children (return values for Join calls)
+    bool *exitedChild;			// Which children have exited?
     unsigned childcount;		// Count of children
+    unsigned childCapacity;		// Size of the three arrays above
 
     int waitchild_id;			// Child I am waiting on (as a result of a Join call)
 
@@ -179,6 +199,18 @@ class Thread {
 
     unsigned instructionCount;          // Keeps track of the instruction count executed by this thread
 
+    bool daemon;			// Not counted when deciding if all threads have exited
+
+    int donatedPriority;		// Best priority of the threads waiting on
+					// locks I hold (UNIX_SCHED only)
+    Lock *heldLocks;			// Locks I hold, chained through Lock::nextHeld
+    Lock *blockedOn;			// Lock I am waiting to acquire, or NULL
+    friend class Lock;
+
+    Thread *queueNext, *queuePrev;	// Links on "queue", which holds no
+    ThreadQueue *queue;			// other storage (see threadqueue.h)
+    friend class ThreadQueue;
+
 #ifdef USER_PROGRAM
 // A thread running a user program actually has *two* sets of CPU registers -- 
 // one for its state while executing user code, one for its state 
@@ -191,6 +223,8 @@ class Thread {
     void RestoreUserState();		// restore user-level register state
 
     AddrSpace *space;			// User code this thread is running.
+    OpenFileTable *openFiles;		// Files opened by the user program
+    AsyncRing *ring;			// Asynchronous calls, NULL if none
 #endif
 };
 
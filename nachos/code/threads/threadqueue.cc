@@ -0,0 +1,117 @@
+// threadqueue.cc
+//	Routines to manage intrusive, doubly-linked queues of threads.
+//	See threadqueue.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "threadqueue.h"
+
+//----------------------------------------------------------------------
+// ThreadQueue::ThreadQueue
+//	Initialize a queue with no threads on it.
+//----------------------------------------------------------------------
+
+ThreadQueue::ThreadQueue()
+{
+    first = last = NULL;
+}
+
+//----------------------------------------------------------------------
+// ThreadQueue::~ThreadQueue
+//	De-allocate a queue.  Threads are not owned by the queue; any
+//	still on it are just unlinked (as List would drop them).
+//----------------------------------------------------------------------
+
+ThreadQueue::~ThreadQueue()
+{
+    while (Remove() != NULL) ;
+}
+
+//----------------------------------------------------------------------
+// ThreadQueue::Append
+//	Put "thread" at the end of the queue.  It must not be on any
+//	queue already.
+//----------------------------------------------------------------------
+
+void
+ThreadQueue::Append(Thread *thread)
+{
+    ASSERT(thread->queue == NULL);
+    thread->queue = this;
+    thread->queueNext = NULL;
+    thread->queuePrev = last;
+    if (last == NULL) first = thread;
+    else last->queueNext = thread;
+    last = thread;
+}
+
+//----------------------------------------------------------------------
+// ThreadQueue::RemoveThread
+//	Unlink "thread", which must be on this queue, from its neighbours.
+//----------------------------------------------------------------------
+
+void
+ThreadQueue::RemoveThread(Thread *thread)
+{
+    ASSERT(thread->queue == this);
+    if (thread->queuePrev == NULL) first = thread->queueNext;
+    else thread->queuePrev->queueNext = thread->queueNext;
+    if (thread->queueNext == NULL) last = thread->queuePrev;
+    else thread->queueNext->queuePrev = thread->queuePrev;
+
+    thread->queue = NULL;
+    thread->queueNext = thread->queuePrev = NULL;
+}
+
+//----------------------------------------------------------------------
+// ThreadQueue::Remove
+//	Take the first thread off the queue, or return NULL if there is
+//	none.
+//----------------------------------------------------------------------
+
+Thread *
+ThreadQueue::Remove()
+{
+    Thread *thread = first;
+
+    if (thread != NULL) RemoveThread(thread);
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// ThreadQueue::RemoveMinPriority
+//	Take the thread with the smallest priority value (the most
+//	urgent one) off the queue.  Among equals the one queued first
+//	wins, so equal priorities are served FIFO.
+//----------------------------------------------------------------------
+
+Thread *
+ThreadQueue::RemoveMinPriority()
+{
+    Thread *thread, *best = first;
+
+    if (best == NULL) return NULL;
+    for (thread = first->queueNext; thread != NULL; thread = thread->queueNext)
+	if (thread->GetPriority() < best->GetPriority())
+	    best = thread;
+    RemoveThread(best);
+    return best;
+}
+
+//----------------------------------------------------------------------
+// ThreadQueue::Mapcar
+//	Apply a function to each thread on the queue, passing the
+//	thread as the argument.  "func" must not change the queue.
+//----------------------------------------------------------------------
+
+void
+ThreadQueue::Mapcar(VoidFunctionPtr func)
+{
+    Thread *thread;
+
+    for (thread = first; thread != NULL; thread = thread->queueNext)
+	(*func)((int) thread);
+}
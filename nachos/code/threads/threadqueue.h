@@ -0,0 +1,53 @@
+// threadqueue.h
+//	Data structures for queues of threads: the ready list, and the
+//	threads waiting on a semaphore, lock, condition and so on.
+//
+//	Unlike List, a ThreadQueue allocates nothing.  The links live in
+//	the Thread itself (queueNext, queuePrev), and the thread records
+//	which queue it is on.  So Append and Remove are a few pointer
+//	writes, and a thread can be taken out of the middle of its queue
+//	in constant time with RemoveThread.
+//
+//	A thread is on at most one ThreadQueue at a time: it is either
+//	READY, on the ready list, or BLOCKED, on the queue of whatever it
+//	waits for (or on none at all, as in Thread::Sleep for SC_Sleep).
+//	One set of links per thread is therefore enough.
+//
+//	NOTE: Mutual exclusion must be provided by the caller, by
+//	disabling interrupts, as for the ready list.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef THREADQUEUE_H
+#define THREADQUEUE_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "thread.h"
+
+class ThreadQueue {
+  public:
+    ThreadQueue();			// initialize the queue to empty
+    ~ThreadQueue();			// de-allocate the queue
+
+    void Append(Thread *thread);	// Put thread at the end of the queue
+    Thread *Remove();			// Take the first thread off the queue,
+					// NULL if it is empty
+    Thread *RemoveMinPriority();	// Take off the most urgent thread (the
+					// smallest GetPriority, first among
+					// equals), NULL if empty
+    void RemoveThread(Thread *thread);	// Take "thread" off, wherever it is
+
+    bool IsEmpty() { return (first == NULL); }
+
+    void Mapcar(VoidFunctionPtr func);	// Apply "func" to every thread on
+					// the queue, first to last
+
+  private:
+    Thread *first;			// Head of the queue, NULL if empty
+    Thread *last;			// Last thread on the queue
+};
+
+#endif // THREADQUEUE_H
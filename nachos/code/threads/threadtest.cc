@@ -4,6 +4,8 @@
 //	Create two threads, and have them context switch
 //	back and forth between themselves by calling Thread::Yield, 
 //	to illustratethe inner workings of the thread system.
+//	Before that, check that a lock lends a waiter's priority to
+//	the lock holder.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -32,6 +34,71 @@ SimpleThread(int which)
     }
 }
 
+//----------------------------------------------------------------------
+// Priority inheritance test, under the UNIX scheduler
+//	A low priority thread takes a lock, and a high priority thread
+//	blocks on it.  The holder should run with the waiter's priority
+//	until it releases the lock, then drop back to its own.  Its own
+//	priority never goes below its base priority, so being below the
+//	base means a loan.  The main thread waits on a condition
+//	protected by the same lock.
+//----------------------------------------------------------------------
+
+static Lock *donationLock;
+static Condition *donationDone;
+static bool donationFinished;
+
+static void
+HighWaiter(int arg)
+{
+    donationLock->Acquire();
+    printf("*** high priority thread got the lock\n");
+    donationFinished = TRUE;
+    donationDone->Signal(donationLock);
+    donationLock->Release();
+}
+
+static void
+LowHolder(int arg)
+{
+    Thread *high = new Thread("high priority waiter", MIN_NICE_PRIORITY);
+
+    donationLock->Acquire();
+    high->UseSmallStack();
+    high->Fork(HighWaiter, 0);
+    currentThread->Yield();		// "high" runs and blocks on the lock
+    printf("*** lock holder boosted while waited for: %s\n",
+	(currentThread->GetPriority() < currentThread->GetBasePriority()) ?
+	"yes" : "NO");
+    donationLock->Release();
+    printf("*** lock holder back to its own priority: %s\n",
+	(currentThread->GetPriority() >= currentThread->GetBasePriority()) ?
+	"yes" : "NO");
+}
+
+static void
+DonationTest()
+{
+    int oldAlgo = schedulingAlgo;
+    Thread *low = new Thread("low priority holder", MAX_NICE_PRIORITY);
+
+    schedulingAlgo = UNIX_SCHED;
+    donationLock = new Lock("donation test lock");
+    donationDone = new Condition("donation test done");
+    donationFinished = FALSE;
+
+    donationLock->Acquire();
+    low->UseSmallStack();
+    low->Fork(LowHolder, 0);
+    while (!donationFinished)
+	donationDone->Wait(donationLock);
+    donationLock->Release();
+
+    delete donationDone;
+    delete donationLock;
+    schedulingAlgo = oldAlgo;
+}
+
 //----------------------------------------------------------------------
 // ThreadTest
 // 	Set up a ping-pong between two threads, by forking a thread 
@@ -43,8 +110,11 @@ ThreadTest()
 {
     DEBUG('t', "Entering SimpleTest");
 
+    DonationTest();
+
     Thread *t = new Thread("forked thread", GET_NICE_FROM_PARENT);
 
+    t->UseSmallStack();
     t->Fork(SimpleThread, 1);
     SimpleThread(0);
 }
@@ -19,34 +19,13 @@
 #include "system.h"
 #include "addrspace.h"
 #include "noff.h"
-
-//----------------------------------------------------------------------
-// SwapHeader
-// 	Do little endian to big endian conversion on the bytes in the 
-//	object file header, in case the file was generated on a little
-//	endian machine, and we're now running on a big endian machine.
-//----------------------------------------------------------------------
-
-static void 
-SwapHeader (NoffHeader *noffH)
-{
-	noffH->noffMagic = WordToHost(noffH->noffMagic);
-	noffH->code.size = WordToHost(noffH->code.size);
-	noffH->code.virtualAddr = WordToHost(noffH->code.virtualAddr);
-	noffH->code.inFileAddr = WordToHost(noffH->code.inFileAddr);
-	noffH->initData.size = WordToHost(noffH->initData.size);
-	noffH->initData.virtualAddr = WordToHost(noffH->initData.virtualAddr);
-	noffH->initData.inFileAddr = WordToHost(noffH->initData.inFileAddr);
-	noffH->uninitData.size = WordToHost(noffH->uninitData.size);
-	noffH->uninitData.virtualAddr = WordToHost(noffH->uninitData.virtualAddr);
-	noffH->uninitData.inFileAddr = WordToHost(noffH->uninitData.inFileAddr);
-}
+#include "pagemerge.h"
 
 //----------------------------------------------------------------------
 // AddrSpace::AddrSpace
 // 	Create an address space to run a user program.
-//	Load the program from a file "executable", and set everything
-//	up so that we can start executing user instructions.
+//	Pages are filled from the image of the program when they are
+//	first touched, so nothing is loaded here.
 //
 //	Assumes that the object code file is in NOFF format.
 //
@@ -57,41 +36,25 @@ SwapHeader (NoffHeader *noffH)
 //  The translation will not be one to one anymore, since we are implementing
 //  demand paging in this Operating System
 //
-//	"executable" is the file containing the object code to load into memory
+//	"execImage" holds the code and data of the program; the new
+//	address space takes over the caller's hold on it.
 //----------------------------------------------------------------------
 
-AddrSpace::AddrSpace(OpenFile *executable)
+AddrSpace::AddrSpace(ExecImage *execImage)
 {
-    NoffHeader noffH;
     unsigned int i, size;
-    unsigned vpn, offset;
-    TranslationEntry *entry;
-    unsigned int pageFrame;
-
-    executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
-    if ((noffH.noffMagic != NOFFMAGIC) && 
-		(WordToHost(noffH.noffMagic) == NOFFMAGIC))
-    	SwapHeader(&noffH);
-    ASSERT(noffH.noffMagic == NOFFMAGIC);
 
 // how big is address space?
-    size = noffH.code.size + noffH.initData.size + noffH.uninitData.size 
-			+ UserStackSize;	// we need to increase the size
+    size = execImage->GetSize() + UserStackSize;	// we need to increase the size
 						// to leave room for the stack
     numPages = divRoundUp(size, PageSize);
     size = numPages * PageSize;
 
-   //G-15 ASSERT(numPages+numPagesAllocated <= NumPhysPages);		// check we're not trying
-										// to run anything too big --
-										// at least until we have
-										// virtual memory
-
 	DEBUG('a', "Initializing address space, num pages %d, size %d\n", numPages, size);
-// first, set up the translation 
+// first, set up the translation; pages are brought in on demand
 	pageTable = new TranslationEntry[numPages];
 	for (i = 0; i < numPages; i++) {
 		pageTable[i].virtualPage = i;
-		// pageTable[i].physicalPage = i+numPagesAllocated;
 		pageTable[i].physicalPage = -1;
 		pageTable[i].valid = FALSE;
 		pageTable[i].use = FALSE;
@@ -100,35 +63,16 @@ AddrSpace::AddrSpace(OpenFile *executable)
 										// a separate page, we could set its 
 										// pages to be read-only
 		pageTable[i].shared = FALSE;
+		pageTable[i].cow = FALSE;
 	}
-// zero out the entire address space, to zero the unitialized data segment 
-// and the stack segment
-    // bzero(&machine->mainMemory[numPagesAllocated*PageSize], size);
- 
-    // numPagesAllocated += numPages;
-
-// then, copy in the code and data segments into memory
-   /* if (noffH.code.size > 0) {
-        DEBUG('a', "Initializing code segment, at 0x%x, size %d\n", 
-			noffH.code.virtualAddr, noffH.code.size);
-        vpn = noffH.code.virtualAddr/PageSize;
-        offset = noffH.code.virtualAddr%PageSize;
-        entry = &pageTable[vpn];
-        pageFrame = entry->physicalPage;
-        executable->ReadAt(&(machine->mainMemory[pageFrame * PageSize + offset]),
-			noffH.code.size, noffH.code.inFileAddr);
-    }
-    if (noffH.initData.size > 0) {
-        DEBUG('a', "Initializing data segment, at 0x%x, size %d\n", 
-			noffH.initData.virtualAddr, noffH.initData.size);
-        vpn = noffH.initData.virtualAddr/PageSize;
-        offset = noffH.initData.virtualAddr%PageSize;
-        entry = &pageTable[vpn];
-        pageFrame = entry->physicalPage;
-        executable->ReadAt(&(machine->mainMemory[pageFrame * PageSize + offset]),
-			noffH.initData.size, noffH.initData.inFileAddr);
-    }*/
-
+	image = execImage;		// held by the caller for us
+	swapSlot = new int[numPages];
+	for (i = 0; i < numPages; i++) swapSlot[i] = SWAP_NONE;
+	backingStore = NULL;
+	numResident = peakResident = 0;
+	numMajorFaults = numMinorFaults = numEvictions = 0;
+	residentLimit = defaultResidentLimit;
+	atomicStart = atomicEnd = 0;
 }
 
 //----------------------------------------------------------------------
@@ -141,45 +85,94 @@ AddrSpace::AddrSpace(AddrSpace *parentSpace)
     numPages = parentSpace->GetNumPages();
     unsigned i, j, k=0, size = numPages * PageSize;
 
-    ASSERT(numPages+numPagesAllocated <= NumPhysPages);                // check we're not trying
+    int src;
+
+    ASSERT((replacementAlgo != 0) || (numPages+numPagesAllocated <= (unsigned) NumPhysPages));	// check we're not trying
                                                                                 // to run anything too big --
                                                                                 // at least until we have
                                                                                 // virtual memory
 
     DEBUG('a', "Initializing address space, num pages %d, size %d\n", numPages, size);
+    image = parentSpace->image;
+    image->Hold();
+    swapSlot = new int[numPages];
+    backingStore = NULL;
+    numResident = peakResident = 0;
+    numMajorFaults = numMinorFaults = numEvictions = 0;
+    residentLimit = parentSpace->residentLimit;
+    atomicStart = parentSpace->atomicStart;
+    atomicEnd = parentSpace->atomicEnd;
     // first, set up the translation
     TranslationEntry* parentPageTable = parentSpace->GetPageTable();
     pageTable = new TranslationEntry[numPages];
     for (i = 0; i < numPages; i++) {
         pageTable[i].virtualPage = i;
+        pageTable[i].physicalPage = -1;
+        pageTable[i].valid = FALSE;
+        pageTable[i].cow = FALSE;
+        swapSlot[i] = SWAP_NONE;
+    }
+    for (i = 0; i < numPages; i++) {
+        pageTable[i].use = parentPageTable[i].use;
+        pageTable[i].dirty = parentPageTable[i].dirty;
+        pageTable[i].readOnly = parentPageTable[i].readOnly;  	// if the code segment was entirely on
+                                        			// a separate page, we could set its
+                                        			// pages to be read-only
+        pageTable[i].shared = parentPageTable[i].shared;
 	    if (parentPageTable[i].shared) {
         	pageTable[i].physicalPage = parentPageTable[i].physicalPage;
+        	pageTable[i].valid = parentPageTable[i].valid;
         }
-        else
+        else if (parentPageTable[i].valid && parentPageTable[i].cow)
+        {
+            // Merged page: the child simply becomes one more
+            // copy-on-write mapping of the same frame
+            pageTable[i].physicalPage = parentPageTable[i].physicalPage;
+            pageTable[i].valid = TRUE;
+            pageTable[i].cow = TRUE;
+            frameCowCount[pageTable[i].physicalPage]++;
+            numResident++;
+        }
+        else if (parentPageTable[i].valid)
         {	
-    		//pageTable[i].physicalPage = numPagesAllocated;
-            if (parentPageTable[i].valid)
-            {
-                while (PhyPageIsAllocated[k]) k++;
-                if (k == NumPhysPages)
-                {
-                    ASSERT(FALSE);
-                }   
-                pageTable[i].physicalPage = k;
-                PhyPageIsAllocated[k] = TRUE;
-                for (j=0 ; j< PageSize; j++){
-    	      		machine->mainMemory[(pageTable[i].physicalPage*PageSize)+j] = machine->mainMemory[(parentPageTable[i].physicalPage*PageSize)+j];
+            // Read the parent's frame number first: finding a frame for
+            // the child may replace this very page of the parent, in
+            // which case the child just inherits the frame.
+            src = parentPageTable[i].physicalPage;
+            k = FindFreeFrame();
+            if ((int)k != src) {
+                for (j=0 ; j< (unsigned) PageSize; j++){
+    	      		machine->mainMemory[(k*PageSize)+j] = machine->mainMemory[(src*PageSize)+j];
                 }
             }
-    		numPagesAllocated++;
+            pageTable[i].physicalPage = k;
+            pageTable[i].valid = TRUE;
+            pageTable[i].dirty = TRUE;	// no backing store copy of our own
+            frameSpace[k] = this;
+            frameVpn[k] = i;
+            numResident++;
+        }
+        else if (parentSpace->swapSlot[i] >= 0)
+        {
+            // Page sits in the compressed pool; keep a copy of our own
+            swapSlot[i] = compressedPool->Duplicate(parentSpace->swapSlot[i]);
+            if (swapSlot[i] < 0) {
+                if (backingStore == NULL) backingStore = new char[numPages * PageSize];
+                compressedPool->Load(parentSpace->swapSlot[i], &backingStore[i * PageSize]);
+                stats->numDiskWrites++;
+                AddSwapLatency(SWAP_DISK_TICKS);
+                swapSlot[i] = SWAP_ON_DISK;
+            }
+        }
+        else if (parentSpace->swapSlot[i] == SWAP_ON_DISK)
+        {
+            if (backingStore == NULL) backingStore = new char[numPages * PageSize];
+            bcopy(&parentSpace->backingStore[i * PageSize], &backingStore[i * PageSize], PageSize);
+            stats->numDiskReads++;
+            stats->numDiskWrites++;
+            AddSwapLatency(2 * SWAP_DISK_TICKS);
+            swapSlot[i] = SWAP_ON_DISK;
         }
-        pageTable[i].valid = parentPageTable[i].valid;
-        pageTable[i].use = parentPageTable[i].use;
-        pageTable[i].dirty = parentPageTable[i].dirty;
-        pageTable[i].readOnly = parentPageTable[i].readOnly;  	// if the code segment was entirely on
-                                        			// a separate page, we could set its
-                                        			// pages to be read-only
-        pageTable[i].shared = parentPageTable[i].shared;
     }
 
     // Copy the contents
@@ -194,6 +187,7 @@ AddrSpace::AddrSpace(AddrSpace *parentSpace)
 
     //numPagesAllocated += numPages;
 //	numPagesAllocated += numPages - j;
+    peakResident = numResident;
 }
 
 //----------------------------------------------------------------------------
@@ -204,6 +198,7 @@ unsigned
 AddrSpace::AllocateSharedMemory(int size )
 {
 	unsigned i , k=0;  
+	int *oldSwapSlot = swapSlot;
 	unsigned TotalPages;					//Number of current pages + pages needed to cover the shared memory
 	unsigned CurrentPages = GetNumPages();
 	unsigned SharedPages = divRoundUp(size, PageSize);
@@ -211,6 +206,15 @@ AddrSpace::AllocateSharedMemory(int size )
 	
 	TranslationEntry* oldPageTable = GetPageTable();
 	pageTable = new TranslationEntry[TotalPages];
+	swapSlot = new int[TotalPages];
+	for (i=0; i<TotalPages; i++) swapSlot[i] = (i < CurrentPages) ? oldSwapSlot[i] : SWAP_NONE;
+	delete [] oldSwapSlot;
+	if (backingStore != NULL) {
+	    char *oldBackingStore = backingStore;
+	    backingStore = new char[TotalPages * PageSize];
+	    bcopy(oldBackingStore, backingStore, CurrentPages * PageSize);
+	    delete [] oldBackingStore;
+	}
 	for (i=0; i<CurrentPages; i++) {
             pageTable[i].virtualPage = i;
             pageTable[i].physicalPage = oldPageTable[i].physicalPage;
@@ -221,18 +225,14 @@ AddrSpace::AllocateSharedMemory(int size )
                                         			// a separate page, we could set its
                                         			// pages to be read-only
 	    pageTable[i].shared = oldPageTable[i].shared;
+	    pageTable[i].cow = oldPageTable[i].cow;
 
 	}
 	for (i=CurrentPages; i<TotalPages; i++) {
            pageTable[i].virtualPage = i;
 
-            while (PhyPageIsAllocated[k]) k++;
-            if (k == NumPhysPages)
-            {
-                ASSERT(FALSE);
-            }   
+            k = FindFreeFrame();		// shared frames are never replaced
             pageTable[i].physicalPage = k;
-            PhyPageIsAllocated[k] = TRUE;
 
            //pageTable[i].physicalPage = i+numPagesAllocated - CurrentPages;
            pageTable[i].valid = TRUE;
@@ -242,11 +242,11 @@ AddrSpace::AllocateSharedMemory(int size )
                                         			// a separate page, we could set its
                                         			// pages to be read-only
             pageTable[i].shared = TRUE;
+            pageTable[i].cow = FALSE;
             stats->numPageFaults++;
 
 	}
 	numPages = TotalPages;
-	numPagesAllocated += SharedPages;
 
 	machine->pageTable = pageTable;
 	machine->pageTableSize = TotalPages;
@@ -255,14 +255,82 @@ AddrSpace::AllocateSharedMemory(int size )
 	return CurrentPages*PageSize;
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::UnsharePages
+// 	Give the pages covering "size" bytes at "vaddr", which must be
+//	mapped as shared memory, a private copy of their frames.  Used
+//	by Fork for a region the child must not keep mapped, such as
+//	the parent's ring, whose frames go away with the ring.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::UnsharePages(int vaddr, int size)
+{
+    unsigned vpn, lastVpn = divRoundUp(vaddr + size, PageSize);
+    int frame;
+
+    for (vpn = vaddr / PageSize; vpn < lastVpn; vpn++) {
+        ASSERT(pageTable[vpn].valid && pageTable[vpn].shared);
+        frame = FindFreeFrame();	// shared frames are never replaced,
+					// so the source stays put
+        bcopy(&machine->mainMemory[pageTable[vpn].physicalPage * PageSize],
+              &machine->mainMemory[frame * PageSize], PageSize);
+        pageTable[vpn].physicalPage = frame;
+        pageTable[vpn].shared = FALSE;
+        pageTable[vpn].dirty = TRUE;	// no backing store copy
+        pageTable[vpn].use = FALSE;
+        frameSpace[frame] = this;
+        frameVpn[frame] = vpn;
+        numResident++;
+    }
+    if (numResident > peakResident) peakResident = numResident;
+}
+
 //----------------------------------------------------------------------
 // AddrSpace::~AddrSpace
-// 	Dealloate an address space.  Nothing for now!
+// 	Dealloate an address space.  Frames must have been given back
+//	with ReleaseMemory already.
 //----------------------------------------------------------------------
 
 AddrSpace::~AddrSpace()
 {
+   unsigned i;
+
+   for (i = 0; i < numPages; i++)
+      if (swapSlot[i] >= 0) compressedPool->Free(swapSlot[i]);
+   delete [] swapSlot;
+   if (backingStore != NULL) delete [] backingStore;
    delete pageTable;
+   image->Release();
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::ReleaseMemory
+// 	Give back the frames and the swap space held by the private pages
+//	of this address space.  Shared memory frames stay allocated,
+//	since other processes may still map them.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::ReleaseMemory()
+{
+   unsigned i;
+
+   for (i = 0; i < numPages; i++) {
+      if (pageTable[i].valid && !pageTable[i].shared) {
+         DEBUG('a', "Releasing frame %d of vpn %d\n", pageTable[i].physicalPage, i);
+         ReleaseUserFrame(&pageTable[i]);	// merged frames stay allocated while
+						// somebody else still maps them
+         pageTable[i].valid = FALSE;
+      }
+      if (swapSlot[i] >= 0) compressedPool->Free(swapSlot[i]);
+      swapSlot[i] = SWAP_NONE;
+   }
+   numResident = 0;
+   if (backingStore != NULL) {
+      delete [] backingStore;
+      backingStore = NULL;
+   }
 }
 
 //----------------------------------------------------------------------
@@ -297,6 +365,82 @@ AddrSpace::InitRegisters()
     DEBUG('a', "Initializing stack register to %d\n", numPages * PageSize - 16);
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::WriteMemory
+// 	Copy "size" bytes to virtual address "vaddr" of this address
+//	space, which need not be the one running.  Pages are brought in
+//	as needed.  Returns FALSE if the range is outside the space.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::WriteMemory(int vaddr, char *from, int size)
+{
+    unsigned vpn;
+    int n;
+
+    if ((vaddr < 0) || (size < 0) || ((unsigned)(vaddr + size) > numPages * PageSize))
+	return FALSE;
+    while (size > 0) {
+	vpn = vaddr / PageSize;
+	if (!pageTable[vpn].valid) PageIn(vpn);
+	if (pageTable[vpn].cow) return FALSE;	// not before the program ran
+	n = PageSize - vaddr % PageSize;
+	if (n > size) n = size;
+	bcopy(from, &machine->mainMemory[pageTable[vpn].physicalPage * PageSize +
+					 vaddr % PageSize], n);
+	pageTable[vpn].dirty = TRUE;
+	from += n;
+	vaddr += n;
+	size -= n;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PushArguments
+// 	Copy "argc" strings of "argv" to the top of the user stack and
+//	pass them to main: r4 gets argc, r5 the address of an argv array
+//	ending with a NULL pointer, and the stack pointer goes below them.
+//	Called after InitRegisters, so it only changes the machine
+//	registers.  Returns FALSE if the arguments take more than
+//	MAX_ARG_BYTES.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::PushArguments(int argc, char **argv)
+{
+    int sp = numPages * PageSize - 16;
+    int total = (argc + 1) * sizeof(int);
+    int *argAddr = new int[argc + 1];
+    int i, len;
+
+    for (i = 0; i < argc; i++) total += strlen(argv[i]) + 1;
+    if (total > MAX_ARG_BYTES) {
+	delete [] argAddr;
+	return FALSE;
+    }
+
+    for (i = argc - 1; i >= 0; i--) {		// the strings first
+	len = strlen(argv[i]) + 1;
+	sp -= len;
+	WriteMemory(sp, argv[i], len);
+	argAddr[i] = WordToMachine(sp);
+    }
+    argAddr[argc] = 0;
+    sp &= ~3;
+    sp -= (argc + 1) * sizeof(int);		// then the argv array
+    WriteMemory(sp, (char *)argAddr, (argc + 1) * sizeof(int));
+    delete [] argAddr;
+
+    machine->WriteRegister(4, argc);
+    machine->WriteRegister(5, sp);
+    sp = (sp - 16) & ~7;			// room for main to save its
+						// arguments, as in the MIPS ABI
+    machine->WriteRegister(StackReg, sp);
+    DEBUG('a', "Passed %d arguments, stack register at %d\n", argc, sp);
+    return TRUE;
+}
+
 //----------------------------------------------------------------------
 // AddrSpace::SaveState
 // 	On a context switch, save any machine state, specific
@@ -335,117 +479,221 @@ AddrSpace::GetPageTable()
 }
 
 //---------------------------------------------------------------------
-//AddrSpace::CopyContent(OpenFile *executable, int vpn)
-//To copy the contents at the time of pageframe allocation
+// AddrSpace::CopyContent
+//	Fill frame "pageFrame" with the code and initialized data of
+//	page "vpn", from the image of the executable.  The caller has
+//	zeroed the frame already.  Returns FALSE if the page is all
+//	zeroes (uninitialized data or stack).
 //---------------------------------------------------------------------
-void
+
+bool
 AddrSpace::CopyContent(unsigned int pageFrame, unsigned vpn)
 {
-    unsigned overlap_start, overlap_end;
-    unsigned copy_vpn, copy_offset;
-    unsigned size;
-    TranslationEntry *copy_entry;
-    NoffHeader noffH;
-    // entry = &pageTable[vpn];
-    OpenFile *executable = fileSystem->Open(currentFile);
-    executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
-    if ((noffH.noffMagic != NOFFMAGIC) && (WordToHost(noffH.noffMagic) == NOFFMAGIC))
-        SwapHeader(&noffH);
-    ASSERT(noffH.noffMagic == NOFFMAGIC);
-   
-   /* size = noffH.code.size + noffH.initData.size + noffH.uninitData.size 
-            + UserStackSize;    // we need to increase the size
-                        // to leave room for the stack
-    numPages = divRoundUp(size, PageSize);
-    size = numPages * PageSize;
-
-    char* temp_array;
-    temp_array = new char[size];
+    return image->CopyPage(&machine->mainMemory[pageFrame * PageSize], vpn);
+}
 
+//----------------------------------------------------------------------
+// AddrSpace::PageIn
+// 	Called on a page fault.  Get a frame, possibly by replacing some
+//	other page, and fill it from wherever the page was left: the
+//	compressed pool, the backing store, or the executable.
+//
+//	An address space at its resident-set limit first gives up one of
+//	its own pages (local replacement).
+//----------------------------------------------------------------------
 
-    if (noffH.code.size > 0) {
-        DEBUG('a', "Initializing code segment, at 0x%x, size %d\n", 
-            noffH.code.virtualAddr, noffH.code.size);
-        copy_vpn = noffH.code.virtualAddr/PageSize;
-        copy_offset = noffH.code.virtualAddr%PageSize;
-        copy_entry = &pageTable[copy_vpn];
-        //pageFrame = entry->physicalPage;
-        executable->ReadAt(&(temp_array[pageFrame * PageSize + copy_offset]),
-            noffH.code.size, noffH.code.inFileAddr);
+void
+AddrSpace::PageIn(unsigned vpn)
+{
+    TranslationEntry *entry = &pageTable[vpn];
+    int frame;
+    char *page;
+
+    while ((residentLimit > 0) && (numResident >= residentLimit))
+        if (!ReplaceLocalPage(this)) break;
+    frame = FindFreeFrame();
+    page = &machine->mainMemory[frame * PageSize];
+
+    if (swapSlot[vpn] >= 0) {
+        compressedPool->Load(swapSlot[vpn], page);
+        compressedPool->Free(swapSlot[vpn]);
+        AddSwapLatency(POOL_LOAD_TICKS);
+        swapSlot[vpn] = SWAP_NONE;
+        entry->dirty = TRUE;		// the only copy is in memory now
+        numMinorFaults++;
+    }
+    else if (swapSlot[vpn] == SWAP_ON_DISK) {
+        bcopy(&backingStore[vpn * PageSize], page, PageSize);
+        stats->numDiskReads++;
+        AddSwapLatency(SWAP_DISK_TICKS);
+        entry->dirty = FALSE;		// backing store copy stays good
+        numMajorFaults++;
     }
-    if (noffH.initData.size > 0) {
-        DEBUG('a', "Initializing data segment, at 0x%x, size %d\n", 
-            noffH.initData.virtualAddr, noffH.initData.size);
-        copy_vpn = noffH.initData.virtualAddr/PageSize;
-        copy_offset = noffH.initData.virtualAddr%PageSize;
-        copy_entry = &pageTable[copy_vpn];
-        // pageFrame = entry->physicalPage;
-        executable->ReadAt(&(temp_array[pageFrame * PageSize + copy_offset]),
-            noffH.initData.size, noffH.initData.inFileAddr);
+    else {
+        bzero(page, PageSize);
+        if (CopyContent(frame, vpn)) numMajorFaults++;
+        else numMinorFaults++;
+        entry->dirty = FALSE;
     }
 
-    for (int j=0 ; j< PageSize; j++){
-                machine->mainMemory[(pageFrame*PageSize)+j] = temp_array[j];
-    }*/
-   if (noffH.code.size > 0) {
-        DEBUG('a', "Initializing code segment, at 0x%x, size %d\n", noffH.code.virtualAddr, noffH.code.size);
-        copy_vpn = noffH.code.virtualAddr/PageSize;
-        copy_offset = noffH.code.virtualAddr%PageSize;
-        copy_entry = &pageTable[copy_vpn];
-        // pageFrame = entry->physicalPage;
-        unsigned code_start = noffH.code.virtualAddr;
-        unsigned code_end = (noffH.code.size + noffH.code.virtualAddr) - 1;
-        unsigned page_start = vpn * PageSize;
-        unsigned page_end = (page_start + PageSize)-1;
-        if (code_start > page_start)
-        {
-            overlap_start = code_start;
-        }
-        else
-        {
-            overlap_start = page_start;
-        }
-        if (code_end < page_end)
-        {
-            overlap_end = code_end;
+    entry->virtualPage = vpn;
+    entry->physicalPage = frame;
+    entry->valid = TRUE;
+    entry->use = FALSE;
+    entry->cow = FALSE;
+    frameSpace[frame] = this;
+    frameVpn[frame] = vpn;
+    numResident++;
+    if (numResident > peakResident) peakResident = numResident;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PageOut
+// 	Called by PageReplacement on the victim page.  A modified page is
+//	compressed into the pool if it fits, otherwise written to the
+//	backing store.  A clean page is just dropped: it can be read back
+//	from the backing store or from the executable.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::PageOut(unsigned vpn)
+{
+    TranslationEntry *entry = &pageTable[vpn];
+    char *page = &machine->mainMemory[entry->physicalPage * PageSize];
+    int slot = -1;
+
+    ASSERT(entry->valid && !entry->shared && !entry->cow);
+    if (entry->dirty) {
+        if (compressedPool != NULL) slot = compressedPool->Store(page);
+        if (slot >= 0) {
+            AddSwapLatency(POOL_STORE_TICKS);
+            swapSlot[vpn] = slot;
         }
-        else
-        {
-            overlap_end = page_end;
+        else {
+            if (backingStore == NULL) backingStore = new char[numPages * PageSize];
+            bcopy(page, &backingStore[vpn * PageSize], PageSize);
+            stats->numDiskWrites++;
+            AddSwapLatency(SWAP_DISK_TICKS);
+            swapSlot[vpn] = SWAP_ON_DISK;
         }
+    }
+    entry->valid = FALSE;
+    entry->dirty = FALSE;
+    entry->use = FALSE;
+    entry->physicalPage = -1;
+    numResident--;
+    numEvictions++;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::RestartAtomicRegion
+// 	Called whenever the user registers of a thread of this space are
+//	saved.  If it was stopped inside its restartable atomic sequence
+//	(but not on its first instruction), make it start the sequence
+//	over, so that the load and store of the sequence are never split
+//	by another thread.  The sequence must not make system calls.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::RestartAtomicRegion(int *registers)
+{
+   int pc = registers[PCReg];
 
-        executable->ReadAt(&(machine->mainMemory[pageFrame*PageSize + copy_offset]), (overlap_end - overlap_start) + 1, noffH.code.inFileAddr + overlap_start - noffH.code.virtualAddr);
+   if ((pc > atomicStart) && (pc < atomicEnd)) {
+      DEBUG('a', "Restarting atomic sequence at 0x%x (was at 0x%x)\n", atomicStart, pc);
+      registers[PCReg] = atomicStart;
+      registers[NextPCReg] = atomicStart + 4;
+   }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::LendFrame
+// 	Used to send a page-aligned message without copying it.  The
+//	page is turned into a copy-on-write mapping (if it is not one
+//	already) and the frame gets one more reference, owned by the
+//	caller; writes by this address space from now on go to a copy.
+//	Returns -1 if the page is not resident, is shared memory, or is
+//	read-only for another reason.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::LendFrame(unsigned vpn)
+{
+    TranslationEntry *entry;
+    int frame;
+
+    if (vpn >= numPages) return -1;
+    entry = &pageTable[vpn];
+    if (!entry->valid || entry->shared || (entry->readOnly && !entry->cow))
+        return -1;
+
+    frame = entry->physicalPage;
+    if (!entry->cow) {
+        entry->cow = TRUE;
+        entry->readOnly = TRUE;
+        frameCowCount[frame] = 1;
     }
-    if (noffH.initData.size > 0) {
-        DEBUG('a', "Initializing data segment, at 0x%x, size %d\n", noffH.initData.virtualAddr, noffH.initData.size);
-        copy_vpn = noffH.initData.virtualAddr/PageSize;
-        copy_offset = noffH.initData.virtualAddr%PageSize;
-        copy_entry = &pageTable[copy_vpn];
-        // pageFrame = entry->physicalPage;
-        unsigned data_end = (noffH.initData.size + noffH.initData.virtualAddr) - 1;
-        unsigned page_start = vpn * PageSize;
-        unsigned data_start = noffH.initData.virtualAddr;
-        unsigned page_end = (page_start + PageSize)-1;
-        
-        if (data_start > page_start)
-        {
-            overlap_start = data_start;
-        }
-        else
-        {
-            overlap_start = page_start;
-        }
-        if (data_end < page_end)
-        {
-            overlap_end = data_end;
-        }
-        else
-        {
-            overlap_end = page_end;
-        }
+    frameCowCount[frame]++;
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::MapLentFrame
+// 	Receiving side of LendFrame: drop whatever page "vpn" held, in
+//	memory or in swap, and map "frame" there copy-on-write.  The
+//	reference the caller got from LendFrame now belongs to the new
+//	mapping.  Returns FALSE, changing nothing, if "vpn" is shared
+//	memory or read-only.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::MapLentFrame(unsigned vpn, int frame)
+{
+    TranslationEntry *entry;
+
+    if (vpn >= numPages) return FALSE;
+    entry = &pageTable[vpn];
+    if (entry->shared || (entry->readOnly && !entry->cow)) return FALSE;
+
+    if (swapSlot[vpn] >= 0) compressedPool->Free(swapSlot[vpn]);
+    swapSlot[vpn] = SWAP_NONE;
+    if (entry->valid) ReleaseUserFrame(entry);
+    else numResident++;
+    if (numResident > peakResident) peakResident = numResident;
+
+    entry->virtualPage = vpn;
+    entry->physicalPage = frame;
+    entry->valid = TRUE;
+    entry->readOnly = TRUE;
+    entry->cow = TRUE;
+    entry->use = FALSE;
+    entry->dirty = TRUE;		// not what the executable holds
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::GetMemStats
+// 	Fill in "into" with the memory counters of this address space
+//	(see memstat.h).  Shared and swapped pages are counted from the
+//	page table, the rest is kept up to date as pages move.
+//----------------------------------------------------------------------
 
-        executable->ReadAt(&(machine->mainMemory[pageFrame*PageSize + copy_offset]), (overlap_end - overlap_start) + 1, noffH.initData.inFileAddr + overlap_start - noffH.initData.virtualAddr);
-    } 
+void
+AddrSpace::GetMemStats(int *into)
+{
+    unsigned i;
+    int numShared = 0, numSwapped = 0;
 
-    
+    for (i = 0; i < numPages; i++) {
+        if (pageTable[i].shared) numShared++;
+        else if (!pageTable[i].valid && (swapSlot[i] != SWAP_NONE)) numSwapped++;
+    }
+    into[MEMSTAT_RESIDENT] = numResident;
+    into[MEMSTAT_PEAK_RESIDENT] = peakResident;
+    into[MEMSTAT_SHARED] = numShared;
+    into[MEMSTAT_SWAPPED] = numSwapped;
+    into[MEMSTAT_MAJOR_FAULTS] = numMajorFaults;
+    into[MEMSTAT_MINOR_FAULTS] = numMinorFaults;
+    into[MEMSTAT_EVICTIONS] = numEvictions;
+    into[MEMSTAT_LIMIT] = residentLimit;
 }
@@ -15,14 +15,18 @@
 
 #include "copyright.h"
 #include "filesys.h"
+#include "memstat.h"
+#include "execimage.h"
 
 #define UserStackSize		1024 	// increase this as necessary!
+#define MAX_ARG_BYTES		(UserStackSize / 2)	// Room for argv and its
+							// strings on the stack
 
 class AddrSpace {
   public:
-    AddrSpace(OpenFile *executable);	// Create an address space,
+    AddrSpace(ExecImage *execImage);	// Create an address space,
 					// initializing it with the program
-					// stored in the file "executable"
+					// in the image "execImage"
 
     AddrSpace (AddrSpace *parentSpace);	// Used by fork
 
@@ -30,6 +34,10 @@ class AddrSpace {
 
     void InitRegisters();		// Initialize user-level CPU registers,
 					// before jumping to user code
+    bool PushArguments(int argc, char **argv);	// Lay out argc/argv for
+					// main, after InitRegisters
+    bool WriteMemory(int vaddr, char *from, int size);	// Copy into this
+					// space, even if it is not running
 
     void SaveState();			// Save/restore address space-specific
     void RestoreState();		// info on a context switch
@@ -38,14 +46,52 @@ class AddrSpace {
 
     TranslationEntry* GetPageTable();
     unsigned AllocateSharedMemory(int size);
-    void CopyContent(unsigned int pageFrame, unsigned vpn);
+    void UnsharePages(int vaddr, int size);	// Private copies of the
+					// shared pages of a region
+    bool CopyContent(unsigned int pageFrame, unsigned vpn);	// FALSE if
+							// nothing was read
 
+    void PageIn(unsigned vpn);		// Bring a page into a free frame
+    void PageOut(unsigned vpn);		// Save a page chosen for replacement
+    void ReleaseMemory();		// Free the frames and swap space of
+					// all private pages (Exit, Exec)
+
+    void GetMemStats(int *into);	// Fill in NUM_MEM_STATS counters,
+					// indexed as in memstat.h
+    void SetResidentLimit(int pages) { residentLimit = pages; }
+    void SetAtomicRegion(int start, int end) { atomicStart = start; atomicEnd = end; }
+    void RestartAtomicRegion(int *registers);	// Back to the start of
+					// the region, if interrupted in it
+    void CountMinorFault() { numMinorFaults++; }	// copy-on-write breaks
+
+    int LendFrame(unsigned vpn);	// Make a resident private page
+					// copy-on-write and return its frame
+					// with one more reference, or -1
+    bool MapLentFrame(unsigned vpn, int frame);	// Replace page "vpn" by
+					// a copy-on-write mapping of "frame",
+					// taking over a reference from LendFrame
 
   private:
     TranslationEntry *pageTable;	// Assume linear page table translation
 					// for now!
     unsigned int numPages;		// Number of pages in the virtual 
 					// address space
+
+    ExecImage *image;			// Where code and data pages come from
+    int *swapSlot;			// Where each evicted page is kept:
+					// SWAP_NONE, SWAP_ON_DISK or a slot
+					// of the compressed pool
+    char *backingStore;			// One page per virtual page, allocated
+					// on first use
+
+    int numResident, peakResident;	// Private pages in physical memory
+    int numMajorFaults, numMinorFaults;	// See memstat.h
+    int numEvictions;			// Our pages chosen by page replacement
+    int residentLimit;			// Most private pages we may keep in
+					// memory (0 for no limit); beyond it
+					// we replace one of our own pages
+    int atomicStart, atomicEnd;		// Restartable atomic sequence of the
+					// program, [atomicStart, atomicEnd)
 };
 
 #endif // ADDRSPACE_H
@@ -0,0 +1,361 @@
+// asyncring.cc
+//	Routines for asynchronous system calls through a shared memory
+//	ring.  See asyncring.h and ring.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "syscall.h"
+#include "synch.h"
+#include "asyncring.h"
+
+extern Semaphore *LookupSemaphore(int semId);
+
+//----------------------------------------------------------------------
+// RingWorker
+// 	Body of the worker thread of "arg", an AsyncRing.  Once the owner
+//	is gone the ring is deleted and the worker finishes.
+//----------------------------------------------------------------------
+
+static void
+RingWorker(int arg)
+{
+    AsyncRing *ring = (AsyncRing *)arg;
+
+    ring->Work();
+    delete ring;
+    processTable->SetExited(currentThread->GetPID());
+}
+
+//----------------------------------------------------------------------
+// SetupAsyncRing
+// 	Map a ring with "entries" slots and "dataSize" bytes of buffers
+//	into the address space of the current thread, and fork its
+//	worker.  The region comes from the shared memory allocator, so its
+//	frames stay put.  Returns NULL for silly sizes.
+//----------------------------------------------------------------------
+
+AsyncRing *
+SetupAsyncRing(int entries, int dataSize)
+{
+    AsyncRing *ring;
+    Thread *worker;
+    int size, vaddr;
+
+    if ((entries <= 0) || (entries > RING_MAX_ENTRIES) || (dataSize < 0))
+	return NULL;
+    size = (RING_HEADER_WORDS + entries * (RING_SQE_WORDS + RING_CQE_WORDS))
+		* sizeof(int) + dataSize;
+    if (divRoundUp(size, PageSize) > NumPhysPages / 4) return NULL;
+
+    vaddr = currentThread->space->AllocateSharedMemory(size);
+    ring = new AsyncRing(currentThread, vaddr, entries, size);
+
+    worker = new Thread("ring worker", GET_NICE_FROM_PARENT);
+    worker->SetDaemon();
+    worker->Fork(RingWorker, (int)ring);
+    return ring;
+}
+
+//----------------------------------------------------------------------
+// AsyncRing::AsyncRing
+// 	Remember the frames behind the region at "vaddr", and clear it.
+//----------------------------------------------------------------------
+
+AsyncRing::AsyncRing(Thread *ringOwner, int vaddr, int entries, int size)
+{
+    TranslationEntry *pageTable = ringOwner->space->GetPageTable();
+    int numRegionPages = divRoundUp(size, PageSize);
+    int i;
+
+    ASSERT((vaddr % PageSize) == 0);
+    owner = ringOwner;
+    baseAddr = vaddr;
+    numEntries = entries;
+    regionSize = size;
+    frames = new int[numRegionPages];
+    for (i = 0; i < numRegionPages; i++) {
+	ASSERT(pageTable[vaddr/PageSize + i].shared);
+	frames[i] = pageTable[vaddr/PageSize + i].physicalPage;
+	bzero(&machine->mainMemory[frames[i] * PageSize], PageSize);
+    }
+    WriteWord(RING_ENTRIES, entries);
+    buffer = new char[RING_CHUNK];
+
+    doorbell = new Semaphore("ring doorbell", 0);
+    completed = new Semaphore("ring completions", 0);
+    waiting = running = closed = FALSE;
+}
+
+//----------------------------------------------------------------------
+// AsyncRing::~AsyncRing
+// 	Called by the worker once the owner has shut the ring down.  The
+//	owner has exited or dropped its old address space by then, and
+//	forked children have copies of the region, so nobody maps the
+//	frames any more and they are freed.
+//----------------------------------------------------------------------
+
+AsyncRing::~AsyncRing()
+{
+    int i;
+
+    for (i = 0; i < divRoundUp(regionSize, PageSize); i++) {
+	PhyPageIsAllocated[frames[i]] = FALSE;
+	numPagesAllocated--;
+    }
+    delete [] frames;
+    delete [] buffer;
+    delete doorbell;
+    delete completed;
+}
+
+//----------------------------------------------------------------------
+// AsyncRing::RegionByte, ReadWord, WriteWord
+// 	Access the region through its frames.  PageSize is a multiple of
+//	four, so a word never straddles two frames.
+//----------------------------------------------------------------------
+
+char *
+AsyncRing::RegionByte(int offset)
+{
+    ASSERT((offset >= 0) && (offset < regionSize));
+    return &machine->mainMemory[frames[offset / PageSize] * PageSize +
+				offset % PageSize];
+}
+
+int
+AsyncRing::ReadWord(int word)
+{
+    return WordToHost(*(unsigned int *)RegionByte(word * sizeof(int)));
+}
+
+void
+AsyncRing::WriteWord(int word, int value)
+{
+    *(unsigned int *)RegionByte(word * sizeof(int)) = WordToMachine(value);
+}
+
+//----------------------------------------------------------------------
+// AsyncRing::CopyIn, CopyOut
+// 	Move "count" bytes between the kernel and the region, a page at
+//	a time.  Buffers must lie entirely inside the region.
+//----------------------------------------------------------------------
+
+bool
+AsyncRing::CopyIn(int vaddr, char *into, int count)
+{
+    int offset = vaddr - baseAddr;
+    int n;
+
+    if ((offset < 0) || (count < 0) || (offset + count > regionSize))
+	return FALSE;
+    while (count > 0) {
+	n = PageSize - offset % PageSize;
+	if (n > count) n = count;
+	bcopy(RegionByte(offset), into, n);
+	into += n;
+	offset += n;
+	count -= n;
+    }
+    return TRUE;
+}
+
+bool
+AsyncRing::CopyOut(int vaddr, char *from, int count)
+{
+    int offset = vaddr - baseAddr;
+    int n;
+
+    if ((offset < 0) || (count < 0) || (offset + count > regionSize))
+	return FALSE;
+    while (count > 0) {
+	n = PageSize - offset % PageSize;
+	if (n > count) n = count;
+	bcopy(from, RegionByte(offset), n);
+	from += n;
+	offset += n;
+	count -= n;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AsyncRing::Execute
+// 	Carry out one submission on behalf of the owner, and return what
+//	the synchronous system call would have returned.  Sleep and SemOp
+//	block the worker, and with it the submissions behind them.
+//
+//	The owner may exit, closing its files, while the worker waits
+//	for the disk, so the file is held for the whole Read or Write.
+//----------------------------------------------------------------------
+
+int
+AsyncRing::Execute(int op, int arg, int vaddr, int count)
+{
+    SharedFile *entry = NULL;
+    Semaphore *sem;
+    int total = 0, n, done;
+
+    switch (op) {
+      case RING_OP_NOP:
+	return 0;
+
+      case RING_OP_READ:
+	entry = owner->openFiles->Lookup(arg);
+	if ((entry == NULL) || (entry->file == NULL) || (count < 0)) return -1;
+	entry->Hold();
+	while (total < count) {
+	    n = ((count - total) < RING_CHUNK) ? (count - total) : RING_CHUNK;
+	    done = entry->file->Read(buffer, n);
+	    if (done <= 0) break;
+	    if (!CopyOut(vaddr + total, buffer, done)) {
+		total = -1;
+		break;
+	    }
+	    total += done;
+	    if (done < n) break;		// end of file
+	}
+	entry->Release();
+	return total;
+
+      case RING_OP_WRITE:
+	if (count < 0) return -1;
+	if ((arg != ConsoleOutput) || !owner->openFiles->IsConsole(arg)) {
+	    entry = owner->openFiles->Lookup(arg);
+	    if ((entry == NULL) || (entry->file == NULL)) return -1;	// not a pipe
+	    entry->Hold();
+	}
+	while (total < count) {
+	    n = ((count - total) < RING_CHUNK) ? (count - total) : RING_CHUNK;
+	    if (!CopyIn(vaddr + total, buffer, n)) {
+		total = -1;
+		break;
+	    }
+	    if (entry == NULL) {
+		kernelConsole->Write(buffer, n);
+		done = n;
+	    }
+	    else done = entry->file->Write(buffer, n);
+	    total += done;
+	    if (done < n) break;
+	}
+	if (entry != NULL) entry->Release();
+	return total;
+
+      case RING_OP_SLEEP:
+	if (arg <= 0) currentThread->Yield();
+	else currentThread->SortedInsertInWaitQueue(stats->totalTicks + arg);
+	return 0;
+
+      case RING_OP_SEMOP:
+	sem = LookupSemaphore(arg);
+	if (sem == NULL) return -1;
+	if (count == -1) sem->P();
+	else if (count == 1) sem->V();
+	else return -1;
+	return 0;
+
+      default:
+	return -1;
+    }
+}
+
+//----------------------------------------------------------------------
+// AsyncRing::Work
+// 	Take submissions in order and post their completions, until the
+//	owner shuts the ring down.  Sleep on the doorbell when there is
+//	nothing to do, or when the completion ring is full.
+//----------------------------------------------------------------------
+
+void
+AsyncRing::Work()
+{
+    int head, tail, cqTail, slot;
+    int op, arg, vaddr, count, userData, result;
+
+    while (!closed) {
+	head = ReadWord(RING_SQ_HEAD);
+	tail = ReadWord(RING_SQ_TAIL);
+	if ((tail - head < 0) || (tail - head > numEntries)) {
+	    printf("[pid %d] Ring: bad submission index %d, dropped\n",
+		owner->GetPID(), tail);
+	    WriteWord(RING_SQ_HEAD, tail);
+	    continue;
+	}
+	cqTail = ReadWord(RING_CQ_TAIL);
+	if ((head == tail) || (cqTail - ReadWord(RING_CQ_HEAD) >= numEntries)) {
+	    doorbell->P();
+	    continue;
+	}
+
+	slot = RING_HEADER_WORDS + (head % numEntries) * RING_SQE_WORDS;
+	op = ReadWord(slot + RING_SQE_OP);
+	arg = ReadWord(slot + RING_SQE_ARG);
+	vaddr = ReadWord(slot + RING_SQE_BUFFER);
+	count = ReadWord(slot + RING_SQE_COUNT);
+	userData = ReadWord(slot + RING_SQE_USER_DATA);
+	WriteWord(RING_SQ_HEAD, head + 1);
+
+	running = TRUE;
+	result = Execute(op, arg, vaddr, count);
+	running = FALSE;
+	if (closed) break;
+	DEBUG('a', "Ring of pid %d: op %d returned %d\n", owner->GetPID(), op, result);
+
+	cqTail = ReadWord(RING_CQ_TAIL);
+	slot = RING_HEADER_WORDS + numEntries * RING_SQE_WORDS +
+		(cqTail % numEntries) * RING_CQE_WORDS;
+	WriteWord(slot + RING_CQE_USER_DATA, userData);
+	WriteWord(slot + RING_CQE_RESULT, result);
+	WriteWord(RING_CQ_TAIL, cqTail + 1);
+
+	if (waiting) {
+	    waiting = FALSE;
+	    completed->V();
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// AsyncRing::Enter, WaitForCompletions
+// 	Called by the owner from sys_RingEnter.
+//----------------------------------------------------------------------
+
+void
+AsyncRing::Enter()
+{
+    doorbell->V();
+}
+
+bool
+AsyncRing::Idle()
+{
+    return (ReadWord(RING_SQ_HEAD) == ReadWord(RING_SQ_TAIL)) && !running;
+}
+
+int
+AsyncRing::WaitForCompletions(int count)
+{
+    if (count > numEntries) count = numEntries;
+    while ((ReadWord(RING_CQ_TAIL) - ReadWord(RING_CQ_HEAD) < count) && !Idle()) {
+	waiting = TRUE;
+	completed->P();
+    }
+    return ReadWord(RING_CQ_TAIL) - ReadWord(RING_CQ_HEAD);
+}
+
+//----------------------------------------------------------------------
+// AsyncRing::Shutdown
+// 	Called when the owner exits or execs.  Submissions not yet taken
+//	are dropped; the worker finishes as soon as it gets to run.
+//----------------------------------------------------------------------
+
+void
+AsyncRing::Shutdown()
+{
+    closed = TRUE;
+    doorbell->V();
+}
@@ -0,0 +1,82 @@
+// asyncring.h
+//	Data structures for asynchronous system calls.
+//
+//	A process may set up one ring: a shared memory region holding a
+//	submission ring, a completion ring and a data area (see ring.h).
+//	The process fills in submissions and rings the doorbell with
+//	sys_RingEnter; a kernel worker thread carries them out in order
+//	and posts one completion for each.  Completions are read straight
+//	from memory, so a batch of requests costs a single trap, and the
+//	process keeps running while the worker blocks on the disk.
+//
+//	Shared memory frames are never replaced, so the worker reads and
+//	writes the region through the frames directly, without going
+//	through the page table of whatever process happens to be running.
+//	The frames belong to the ring: a forked child gets copies, and
+//	they are freed when the worker deletes the ring.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef ASYNCRING_H
+#define ASYNCRING_H
+
+#include "copyright.h"
+#include "ring.h"
+
+class Thread;
+class Semaphore;
+
+#define RING_CHUNK		1024	// Bytes of a Read/Write buffered at once
+
+class AsyncRing {
+  public:
+    AsyncRing(Thread *ringOwner, int vaddr, int entries, int size);
+					// The region at "vaddr" is already
+					// mapped as shared memory
+    ~AsyncRing();
+
+    void Enter();			// Called by sys_RingEnter: there may
+					// be new submissions
+    int WaitForCompletions(int count);	// Wait until "count" completions
+					// are unread, or nothing is pending;
+					// return the number unread
+    void Shutdown();			// The owner exits or execs; the
+					// worker stops and deletes the ring
+
+    void Work();			// Body of the worker thread
+
+    int GetAddress() { return baseAddr; }
+    int GetSize() { return regionSize; }
+
+  private:
+    char *RegionByte(int offset);	// Host address of a byte of the region
+    int ReadWord(int word);		// Word "word" of the region
+    void WriteWord(int word, int value);
+    bool CopyIn(int vaddr, char *into, int count);	// FALSE if not all of
+    bool CopyOut(int vaddr, char *from, int count);	// it is in the region
+    int Execute(int op, int arg, int vaddr, int count);	// Returns the result
+
+    bool Idle();			// No submission pending or running
+
+    Thread *owner;
+    int baseAddr;			// Virtual address of the region
+    int numEntries;
+    int regionSize;			// In bytes
+    int *frames;			// Frame of each page of the region
+    char *buffer;			// RING_CHUNK bytes for Read/Write
+
+    Semaphore *doorbell;		// Signalled by Enter and Shutdown
+    Semaphore *completed;		// Signalled when the owner waits and
+					// a completion is posted
+    bool waiting;			// Owner is in WaitForCompletions
+    bool running;			// Worker is carrying out a submission
+    bool closed;			// Set by Shutdown
+};
+
+extern AsyncRing *SetupAsyncRing(int entries, int dataSize);
+					// Map a region for the current thread
+					// and fork its worker; NULL on error
+
+#endif // ASYNCRING_H
@@ -0,0 +1,144 @@
+// bufconsole.cc
+//	Routines for the kernel's buffered console.  See bufconsole.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "bufconsole.h"
+
+// Dummy functions because C++ is weird about pointers to member functions
+static void BufferedConsoleWriteDone(int c)
+{ BufferedConsole *bc = (BufferedConsole *)c; bc->WriteDone(); }
+static void BufferedConsoleReadAvail(int c)
+{ BufferedConsole *bc = (BufferedConsole *)c; bc->ReadAvail(); }
+
+//----------------------------------------------------------------------
+// BufferedConsole::BufferedConsole
+// 	Create the console device (on stdin and stdout) and an empty
+//	output buffer of "bufferSize" bytes.
+//----------------------------------------------------------------------
+
+BufferedConsole::BufferedConsole(int bufferSize)
+{
+    size = bufferSize;
+    ring = new char[size];
+    head = queued = 0;
+    busy = FALSE;
+    slotsFree = new Semaphore("console buffer slots", size);
+    charAvail = new Semaphore("console chars typed", 0);
+    console = new Console(NULL, NULL, BufferedConsoleReadAvail,
+			BufferedConsoleWriteDone, (int)this);
+}
+
+//----------------------------------------------------------------------
+// BufferedConsole::~BufferedConsole
+// 	Write out any pending output and delete the device.
+//----------------------------------------------------------------------
+
+BufferedConsole::~BufferedConsole()
+{
+    Flush();
+    delete console;
+    delete slotsFree;
+    delete charAvail;
+    delete [] ring;
+}
+
+//----------------------------------------------------------------------
+// BufferedConsole::Write
+// 	Copy "count" bytes into the output buffer, starting the device if
+//	it is idle.  Returns as soon as the last byte is queued.
+//----------------------------------------------------------------------
+
+void
+BufferedConsole::Write(char *data, int count)
+{
+    IntStatus oldLevel;
+    int i;
+
+    for (i = 0; i < count; i++) {
+	slotsFree->P();			// waits only if the buffer is full
+	oldLevel = interrupt->SetLevel(IntOff);
+	ring[(head + queued) % size] = data[i];
+	queued++;
+	if (!busy) StartOutput();
+	(void) interrupt->SetLevel(oldLevel);
+    }
+}
+
+//----------------------------------------------------------------------
+// BufferedConsole::StartOutput
+// 	Give the oldest queued byte to the device.  Called with
+//	interrupts off.
+//----------------------------------------------------------------------
+
+void
+BufferedConsole::StartOutput()
+{
+    char ch = ring[head];
+
+    ASSERT(queued > 0);
+    head = (head + 1) % size;
+    queued--;
+    busy = TRUE;
+    console->PutChar(ch);		// the device has its own copy now
+    slotsFree->V();
+}
+
+//----------------------------------------------------------------------
+// BufferedConsole::WriteDone
+// 	Interrupt handler: the device can take the next byte.
+//----------------------------------------------------------------------
+
+void
+BufferedConsole::WriteDone()
+{
+    busy = FALSE;
+    if (queued > 0) StartOutput();
+}
+
+//----------------------------------------------------------------------
+// BufferedConsole::ReadAvail, BufferedConsole::GetChar
+// 	A character typed at the keyboard is handed to the first thread
+//	waiting in GetChar.
+//----------------------------------------------------------------------
+
+void
+BufferedConsole::ReadAvail()
+{
+    charAvail->V();
+}
+
+char
+BufferedConsole::GetChar()
+{
+    charAvail->P();
+    return console->GetChar();
+}
+
+//----------------------------------------------------------------------
+// BufferedConsole::Flush
+// 	Write the queued bytes straight to stdout (where the device
+//	writes).  Used when the machine halts, since no more console
+//	interrupts will happen.
+//----------------------------------------------------------------------
+
+void
+BufferedConsole::Flush()
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    int count, i;
+
+    fflush(stdout);			// keep kernel printfs in order
+    while (queued > 0) {
+	count = (head + queued <= size) ? queued : (size - head);
+	WriteFile(1, &ring[head], count);
+	head = (head + count) % size;
+	queued -= count;
+	for (i = 0; i < count; i++) slotsFree->V();
+    }
+    (void) interrupt->SetLevel(oldLevel);
+}
@@ -0,0 +1,55 @@
+// bufconsole.h
+//	Data structures for the kernel's buffered console.
+//
+//	User programs print through a ring buffer in the kernel.  A write
+//	copies its bytes into the buffer and returns; the buffer is drained
+//	one character per console interrupt in the background.  A writer
+//	only waits when the buffer is full.
+//
+//	There is one BufferedConsole, owned by the kernel and created in
+//	Initialize; it also hands out characters typed at the keyboard.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef BUFCONSOLE_H
+#define BUFCONSOLE_H
+
+#include "copyright.h"
+#include "console.h"
+#include "synch.h"
+
+#define CONSOLE_BUFFER_SIZE	1024	// Bytes of output held by the kernel
+
+class BufferedConsole {
+  public:
+    BufferedConsole(int bufferSize);	// Create the console device
+    ~BufferedConsole();
+
+    void Write(char *data, int count);	// Queue "count" bytes for output
+    int FreeSpace() { return size - queued; }	// Bytes Write can take
+					// without waiting
+    char GetChar();			// Wait for a character from the
+					// keyboard
+    void Flush();			// Write out whatever is still queued,
+					// without waiting (used by Halt)
+
+    void WriteDone();			// Interrupt handlers, called by the
+    void ReadAvail();			// console device
+
+  private:
+    void StartOutput();			// Hand the next queued byte to the
+					// device
+
+    Console *console;
+    char *ring;				// Output not yet given to the device
+    int size;				// Capacity of "ring"
+    int head;				// Next byte to give to the device
+    int queued;				// Bytes in "ring"
+    bool busy;				// Is the device writing a character?
+    Semaphore *slotsFree;		// One count per free byte of "ring"
+    Semaphore *charAvail;		// Counts characters typed
+};
+
+#endif // BUFCONSOLE_H
@@ -28,35 +28,19 @@
 #include "synch.h"
 #include "noff.h"
 #include "sysdep.h"
+#include "pagemerge.h"
+#include "asyncring.h"
+#include "futex.h"
+#include "semset.h"
+#include "msgqueue.h"
+#include "pipe.h"
 
-//----------------------------------------------------------------------
-// ExceptionHandler
-// 	Entry point into the Nachos kernel.  Called when a user program
-//	is executing, and either does a syscall, or generates an addressing
-//	or arithmetic exception.
-//
-// 	For system calls, the following is the calling convention:
-//
-// 	system call code -- r2
-//		arg1 -- r4
-//		arg2 -- r5
-//		arg3 -- r6
-//		arg4 -- r7
-//
-//	The result of the system call, if any, must be put back into r2. 
-//
-// And don't forget to increment the pc before returning. (Or else you'll
-// loop making the same system call forever!
-//
-//	"which" is the kind of exception.  The list of possible exceptions 
-//	are in machine.h.
-//----------------------------------------------------------------------
-static Semaphore *readAvail;
-static Semaphore *writeDone;
-static void ReadAvail(int arg) { readAvail->V(); }
-static void WriteDone(int arg) { writeDone->V(); }
+#define PRINT_CHUNK	128		// Bytes of a string copied in at once
+#define FILE_CHUNK	1024		// Bytes of a file transfer buffered at once
+#define MAX_ARGS	16		// Arguments passed by sys_Spawn
 
-extern void StartProcess (char*);
+extern Thread *SpawnProcess(char *filename, int nice, int argc, char **argv,
+                            OpenFileTable *files);
 extern int PageReplacement();
 
 void
@@ -66,622 +50,1417 @@ ForkStartFunction (int dummy)
    machine->Run();
 }
 
-static void ConvertIntToHex (unsigned v, Console *console)
+//----------------------------------------------------------------------
+// FindFreeFrame
+// 	Return the first unallocated physical frame and mark it allocated.
+//	Falls back to page replacement when memory is full.  The caller
+//	fills in frameSpace/frameVpn if the frame may later be replaced.
+//----------------------------------------------------------------------
+
+int FindFreeFrame()
+{
+	int i = 0;
+
+	while ((i < NumPhysPages) && PhyPageIsAllocated[i]) i++;
+
+	if (i == NumPhysPages)								// Entry to this 'if' marks a page replacement
+	{
+		if (replacementAlgo != 0)
+		{
+			i = PageReplacement();
+		}
+		else {
+			ASSERT(FALSE);
+		}
+	}
+	PhyPageIsAllocated[i] = TRUE;
+	numPagesAllocated++;
+	frameSpace[i] = NULL;
+	frameLoadTime[i] = frameLastUse[i] = stats->totalTicks;
+	return i;
+}
+
+//----------------------------------------------------------------------
+// AdvancePC
+// 	Move the user program counters past the syscall instruction.
+//	Done before the handler runs, so that a forked child starts
+//	after the syscall and a blocked caller resumes after it.
+//----------------------------------------------------------------------
+
+static void
+AdvancePC()
+{
+   machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
+   machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
+   machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
+}
+
+//----------------------------------------------------------------------
+// System call handlers.  Arguments are in r4..r7 and the result, if
+// any, goes in r2 (see ExceptionHandler).
+//----------------------------------------------------------------------
+
+static void
+SysHalt()
+{
+   DEBUG('a', "Shutdown, initiated by user program.\n");
+   interrupt->Halt();
+}
+
+static void
+SysExit()
+{
+   int exitcode = machine->ReadRegister(4);
+
+   printf("[pid %d]: Exit called. Code: %d\n", currentThread->GetPID(), exitcode);
+   // We do not wait for the children to finish.
+   // The children will continue to run.
+   // We will worry about this when and if we implement signals.
+   processTable->SetExited(currentThread->GetPID());
+   currentThread->space->GetMemStats(processTable->GetMemStats(currentThread->GetPID()));	// for Halt
+   currentThread->space->ReleaseMemory();	// frames can go to other processes now
+   if (currentThread->ring != NULL) currentThread->ring->Shutdown();
+   currentThread->ring = NULL;
+   delete currentThread->openFiles;		// close whatever is still open
+   currentThread->openFiles = NULL;
+
+   // Were we the last thread that had not called exit?
+   currentThread->Exit(processTable->NumLive() == 0, exitcode);
+}
+
+//----------------------------------------------------------------------
+// CopyArgumentsFromUser
+// 	Copy the program name at "vaddr" into "path" (FILE_CHUNK bytes)
+//	and the NULL terminated argument vector at "argvAddr" into "argv"
+//	(MAX_ARGS entries), whose strings are kept in "strings"
+//	(MAX_ARG_BYTES).  A NULL "argvAddr" stands for just the name.
+//	Returns argc, or -1 if something is unreadable or too long.
+//----------------------------------------------------------------------
+
+static int
+CopyArgumentsFromUser(int vaddr, int argvAddr, char *path, char **argv,
+                      char *strings)
+{
+   int argc = 0, used = 0, length, word;
+
+   length = machine->CopyStringFromUser(vaddr, path, FILE_CHUNK);
+   if ((length <= 0) || (length == FILE_CHUNK)) return -1;
+
+   if (argvAddr == 0) {
+      argv[argc++] = path;
+      return argc;
+   }
+   for (;;) {				// one pointer, then its string
+      if (!machine->CopyFromUser(argvAddr + 4*argc, (char *)&word, 4)) return -1;
+      word = WordToHost(word);
+      if (word == 0) return argc;
+      if (argc == MAX_ARGS) return -1;
+      length = machine->CopyStringFromUser(word, &strings[used], MAX_ARG_BYTES - used);
+      if ((length < 0) || (used + length == MAX_ARG_BYTES)) return -1;
+      argv[argc++] = &strings[used];
+      used += length + 1;
+   }
+}
+
+//----------------------------------------------------------------------
+// SysExec
+// 	Replace the program of the calling process by the one named by
+//	r4, passing it the argument vector at r5 (see sys_Spawn).  The
+//	new address space is built and its arguments laid out before the
+//	old one is torn down, so that a failing Exec returns -1 to a
+//	caller that is still intact.  Otherwise the old frames, swap
+//	space and ring go back to the system and the process, with its
+//	pid, children and open files, starts over in the new program.
+//----------------------------------------------------------------------
+
+static void
+SysExec()
+{
+   char *path = new char[FILE_CHUNK];
+   char *strings = new char[MAX_ARG_BYTES];
+   char *argv[MAX_ARGS];
+   int argc = CopyArgumentsFromUser(machine->ReadRegister(4),
+                                    machine->ReadRegister(5), path, argv, strings);
+   ExecImage *image = (argc < 0) ? NULL : LoadExecImage(path);
+   AddrSpace *space = NULL;
+
+   if (image != NULL) {
+      space = new AddrSpace(image);
+      currentThread->SaveUserState();		// InitRegisters overwrites them
+      space->InitRegisters();
+      if (!space->PushArguments(argc, argv)) {
+         currentThread->RestoreUserState();
+         space->ReleaseMemory();
+         delete space;
+         space = NULL;
+      }
+   }
+   delete [] path;
+   delete [] strings;
+   if (space == NULL) {
+      DEBUG('a', "Exec: cannot start program named at 0x%x\n", machine->ReadRegister(4));
+      machine->WriteRegister(2, -1);
+      return;
+   }
+
+   currentThread->space->ReleaseMemory();	// frees frames, pool slots and backing store
+   delete currentThread->space;			// and drops the old image
+   if (currentThread->ring != NULL) currentThread->ring->Shutdown();
+   currentThread->ring = NULL;
+   currentThread->space = space;
+   space->RestoreState();			// load page table register
+   WaitForSwapIO();				// for the argument pages
+}
+
+//----------------------------------------------------------------------
+// SysSpawn
+// 	Start the program named by r4 in a new process, with the NULL
+//	terminated argument vector at r5 (or just its name, if r5 is
+//	NULL).  Nothing of the caller's address space is copied.  The
+//	child shares the caller's ConsoleInput and ConsoleOutput, but
+//	no other open file: a pipe end it inherited unknowingly could
+//	keep the other end from ever seeing end of file.
+//	Returns the pid of the child, or -1.
+//----------------------------------------------------------------------
+
+static void
+SysSpawn()
+{
+   char *path = new char[FILE_CHUNK];
+   char *strings = new char[MAX_ARG_BYTES];
+   char *argv[MAX_ARGS];
+   int argc = CopyArgumentsFromUser(machine->ReadRegister(4),
+                                    machine->ReadRegister(5), path, argv, strings);
+   Thread *child = NULL;
+
+   if (argc >= 0) {
+      child = SpawnProcess(path, GET_NICE_FROM_PARENT, argc, argv,
+                           new OpenFileTable(currentThread->openFiles,
+                                             FIRST_FILE_ID));
+      WaitForSwapIO();			// for the argument pages
+   }
+   if (child == NULL)
+      DEBUG('a', "Spawn: cannot start program named at 0x%x\n", machine->ReadRegister(4));
+   machine->WriteRegister(2, (child != NULL) ? child->GetPID() : -1);
+   delete [] path;
+   delete [] strings;
+}
+
+static void
+SysJoin()
 {
-   unsigned x;
-   if (v == 0) return;
-   ConvertIntToHex (v/16, console);
-   x = v % 16;
-   if (x < 10) {
-      writeDone->P() ;
-      console->PutChar('0'+x);
+   int waitpid = machine->ReadRegister(4);
+   // Check if this is my child. If not, return -1.
+   int whichChild = currentThread->CheckIfChild (waitpid);
+
+   if (whichChild == -1) {
+      printf("[pid %d] Cannot join with non-existent child [pid %d].\n", currentThread->GetPID(), waitpid);
+      machine->WriteRegister(2, -1);
    }
    else {
-      writeDone->P() ;
-      console->PutChar('a'+x-10);
+      machine->WriteRegister(2, currentThread->JoinWithChild (whichChild));
    }
 }
 
-int PageReplacement()
+static void
+SysFork()
 {
-	if (replacementAlgo == 1)
-	{
-		printf("%d , %d , %d\n", Random(), Random()%NumPhysPages, NumPhysPages);
-	}
+   Thread *child = new Thread("Forked thread", GET_NICE_FROM_PARENT);
+
+   child->space = new AddrSpace (currentThread->space);  // Duplicates the address space
+   if (currentThread->ring != NULL)		// the ring is not inherited
+      child->space->UnsharePages(currentThread->ring->GetAddress(),
+                                 currentThread->ring->GetSize());
+   WaitForSwapIO();				// for pages copied through swap
+   if (currentThread->openFiles != NULL)	// share the open files
+      child->openFiles = new OpenFileTable(currentThread->openFiles, MAX_OPEN_FILES);
+   else child->openFiles = new OpenFileTable;
+   child->SaveUserState ();		     		      // Duplicate the register set
+   child->ResetReturnValue ();			     // Sets the return register to zero
+   child->StackAllocate (ForkStartFunction, 0);	// Make it ready for a later context switch
+   child->Schedule ();
+   machine->WriteRegister(2, child->GetPID());		// Return value for parent
 }
 
-void
-ExceptionHandler(ExceptionType which)
+static void
+SysYield()
 {
-    int type = machine->ReadRegister(2);
-    int memval, vaddr, printval, tempval, exp;
-    unsigned printvalus;	// Used for printing in hex
-    if (!initializedConsoleSemaphores) {
-       readAvail = new Semaphore("read avail", 0);
-       writeDone = new Semaphore("write done", 1);
-       initializedConsoleSemaphores = true;
-    }
-    Console *console = new Console(NULL, NULL, ReadAvail, WriteDone, 0);
-    int exitcode;		// Used in syscall_Exit
-    unsigned i;
-    char buffer[1024];		// Used in syscall_Exec
-    int waitpid;		// Used in syscall_Join
-    int whichChild;		// Used in syscall_Join
-    Thread *child;		// Used by syscall_Fork
-    unsigned sleeptime;		// Used by syscall_Sleep
-    int size;			// Used in syscall_ShmAllocate	
-    int semKey; 		// Used in syscall_SemGet
-    int semId; 			// Used in syscall_SemGet
-    int adjustment_value; 	// Used in syscall_SemOp
-    int PhyAddr; 		// Used in syscall_SemCtl
-    int condId;			// Used in syscall_CondGet
-    int condKey;		// Used in syscall_CondGet
-    unsigned va;       //used in PageFaultException
-    unsigned vpn;       //used in PageFaultException
-
-
-    if ((which == SyscallException) && (type == syscall_Halt)) {
-	DEBUG('a', "Shutdown, initiated by user program.\n");
-   	interrupt->Halt();
-    }
-    else if ((which == SyscallException) && (type == syscall_Exit)) {
-       exitcode = machine->ReadRegister(4);
-       printf("[pid %d]: Exit called. Code: %d\n", currentThread->GetPID(), exitcode);
-       // We do not wait for the children to finish.
-       // The children will continue to run.
-       // We will worry about this when and if we implement signals.
-       exitThreadArray[currentThread->GetPID()] = true;
-
-       // Find out if all threads have called exit
-       for (i=0; i<thread_index; i++) {
-          if (!exitThreadArray[i]) break;
-       }
-       currentThread->Exit(i==thread_index, exitcode);
-    }
+   currentThread->Yield();
+}
 
+static void
+SysPrintInt()
+{
+   char buffer[16];
 
-    else if ((which == SyscallException) && (type == syscall_Exec)) {
-       // Copy the executable name into kernel space
-       vaddr = machine->ReadRegister(4);
-       printf("vaddr:%d\n", vaddr);
-       machine->ReadMem(vaddr, 1, &memval);
+   sprintf(buffer, "%d", machine->ReadRegister(4));
+   kernelConsole->Write(buffer, strlen(buffer));
+}
 
-       i = 0;
-       while ((*(char*)&memval) != '\0') {
-          buffer[i] = (*(char*)&memval);
-          i++;
-          vaddr++;
-          machine->ReadMem(vaddr, 1, &memval);
-       }
-       buffer[i] = (*(char*)&memval);
-
-       /*
-       *    for deletion of Caller's pageTable: Group 15 ki karamat
-       */
-       TranslationEntry* pageTable;
-       unsigned i;
-       unsigned numberOfPages;
-       int index;
-       int count = 0;
-
-       pageTable = currentThread->space->GetPageTable();
-       DEBUG('a', "size of pageTable = %d.\n Get the int value of pageTable printed : %d\n", sizeof *pageTable, pageTable->valid);			//G-15
-       numberOfPages = currentThread->space->GetNumPages();
-       DEBUG('a', "The number of pages in the page table = %d || check for GetNumPages.\n", numberOfPages);		//G-15
-
-       for(i=0; i<numberOfPages; i++)
-       {
-           if (pageTable[i].shared != TRUE)
-           {
-               index = pageTable[i].physicalPage;
-               DEBUG('a', "The index in the for loop = %d\n", index);		//G-15
-               PhyPageIsAllocated[index] = FALSE;
-               count++;
-           }
-       }
-       printf("BUFFER ARRAY: %s\n", buffer);
-       delete pageTable;//currentThread->space;
-       numPagesAllocated -= count;
-       printf("The place of Seg Fault\n");
-       StartProcess(buffer);
+static void
+SysPrintChar()
+{
+   char ch = machine->ReadRegister(4);
+
+   kernelConsole->Write(&ch, 1);
+}
+
+static void
+SysPrintString()
+{
+   char buffer[PRINT_CHUNK];
+   int vaddr = machine->ReadRegister(4);
+   int length;
+
+   do {					// one chunk of the string at a time
+      length = machine->CopyStringFromUser(vaddr, buffer, PRINT_CHUNK);
+      if (length > 0) kernelConsole->Write(buffer, length);
+      vaddr += length;
+   } while (length == PRINT_CHUNK);
+   if (length < 0)
+      DEBUG('a', "PrintString: bad address 0x%x\n", vaddr);
+}
+
+//----------------------------------------------------------------------
+// File system calls.  Names and data are copied between user memory
+// and the kernel a chunk at a time with the Machine copy routines, so
+// a transfer costs one translation per page rather than one per byte.
+//----------------------------------------------------------------------
+
+static void
+SysCreate()
+{
+   char name[FILE_CHUNK];
+   int vaddr = machine->ReadRegister(4);
+   int length = machine->CopyStringFromUser(vaddr, name, FILE_CHUNK);
+
+   if ((length <= 0) || (length == FILE_CHUNK) || !fileSystem->Create(name, 0)) {
+      DEBUG('a', "Create: cannot create file named at 0x%x\n", vaddr);
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   machine->WriteRegister(2, 0);
+}
+
+static void
+SysOpen()
+{
+   char name[FILE_CHUNK];
+   int vaddr = machine->ReadRegister(4);
+   int length = machine->CopyStringFromUser(vaddr, name, FILE_CHUNK);
+   OpenFile *file;
+   int id;
+
+   if ((length <= 0) || (length == FILE_CHUNK)) {
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   file = fileSystem->Open(name);
+   if (file == NULL) {
+      DEBUG('a', "Open: no file %s\n", name);
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   id = currentThread->openFiles->Add(file);
+   if (id == -1) {
+      printf("[pid %d] Open: too many open files\n", currentThread->GetPID());
+      delete file;
+   }
+   machine->WriteRegister(2, id);
+}
+
+//----------------------------------------------------------------------
+// SysRead
+// 	ConsoleInput waits for at least one character and stops at the
+//	end of a line.  Pipes wait for at least one byte and return what
+//	is buffered.  Files return whatever is left, up to "size".
+//----------------------------------------------------------------------
+
+static void
+SysRead()
+{
+   char buffer[FILE_CHUNK];
+   int vaddr = machine->ReadRegister(4);
+   int size = machine->ReadRegister(5);
+   int id = machine->ReadRegister(6);
+   int total = 0, count, done;
+   OpenFile *file;
+   SharedFile *entry;
+
+   if ((id == ConsoleInput) && currentThread->openFiles->IsConsole(id)) {
+      while (total < size) {
+         count = 0;
+         do {
+            buffer[count] = kernelConsole->GetChar();
+            count++;
+         } while ((count < FILE_CHUNK) && (total + count < size) &&
+                  (buffer[count-1] != '\n'));
+         if (!machine->CopyToUser(vaddr + total, buffer, count)) {
+            machine->WriteRegister(2, -1);
+            return;
+         }
+         total += count;
+         if (buffer[count-1] == '\n') break;
+      }
+      machine->WriteRegister(2, total);
+      return;
+   }
+
+   entry = currentThread->openFiles->Lookup(id);
+   if ((entry != NULL) && (entry->pipe != NULL) && !entry->writeEnd && (size >= 0)) {
+      while (total < size) {			// only the first chunk waits
+         count = ((size - total) < FILE_CHUNK) ? (size - total) : FILE_CHUNK;
+         done = entry->pipe->Read(buffer, count, total == 0);
+         if (!machine->CopyToUser(vaddr + total, buffer, done)) {
+            machine->WriteRegister(2, -1);
+            return;
+         }
+         total += done;
+         if (done < count) break;		// drained, or end of file
+      }
+      machine->WriteRegister(2, total);
+      return;
+   }
+
+   file = currentThread->openFiles->Get(id);
+   if ((file == NULL) || (size < 0)) {
+      printf("[pid %d] Read: bad file id %d\n", currentThread->GetPID(), id);
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   while (total < size) {
+      count = ((size - total) < FILE_CHUNK) ? (size - total) : FILE_CHUNK;
+      done = file->Read(buffer, count);
+      if (done <= 0) break;
+      if (!machine->CopyToUser(vaddr + total, buffer, done)) {
+         DEBUG('a', "Read: bad address 0x%x\n", vaddr + total);
+         machine->WriteRegister(2, -1);
+         return;
+      }
+      total += done;
+      if (done < count) break;			// end of file
+   }
+   machine->WriteRegister(2, total);
+}
+
+//----------------------------------------------------------------------
+// SysWrite
+// 	ConsoleOutput goes through the console buffer; files and pipes
+//	are written a chunk at a time.  Returns the number of bytes
+//	written; -1 for a pipe that has no read end left.
+//----------------------------------------------------------------------
+
+static void
+SysWrite()
+{
+   char buffer[FILE_CHUNK];
+   int vaddr = machine->ReadRegister(4);
+   int size = machine->ReadRegister(5);
+   int id = machine->ReadRegister(6);
+   int total = 0, count, done;
+   OpenFile *file = NULL;
+   SharedFile *entry = NULL;
+
+   if ((id != ConsoleOutput) || !currentThread->openFiles->IsConsole(id)) {
+      entry = currentThread->openFiles->Lookup(id);
+      if ((entry == NULL) || ((entry->pipe != NULL) && !entry->writeEnd) || (size < 0)) {
+         printf("[pid %d] Write: bad file id %d\n", currentThread->GetPID(), id);
+         machine->WriteRegister(2, -1);
+         return;
+      }
+      file = entry->file;
+   }
+   while (total < size) {
+      count = ((size - total) < FILE_CHUNK) ? (size - total) : FILE_CHUNK;
+      if (!machine->CopyFromUser(vaddr + total, buffer, count)) {
+         DEBUG('a', "Write: bad address 0x%x\n", vaddr + total);
+         machine->WriteRegister(2, -1);
+         return;
+      }
+      if (entry == NULL) {
+         kernelConsole->Write(buffer, count);
+         done = count;
+      }
+      else if (file != NULL) done = file->Write(buffer, count);
+      else done = entry->pipe->Write(buffer, count);
+      total += done;
+      if (done < count) break;
+   }
+   if ((entry != NULL) && (entry->pipe != NULL) && (total == 0) && (size > 0))
+      total = -1;				// nobody will ever read it
+   machine->WriteRegister(2, total);
+}
+
+static void
+SysClose()
+{
+   int id = machine->ReadRegister(4);
+
+   if (!currentThread->openFiles->Close(id)) {
+      DEBUG('a', "Close: bad file id %d\n", id);
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   machine->WriteRegister(2, 0);
+}
+
+//----------------------------------------------------------------------
+// SysPipe
+// 	Create a pipe and store its read and write ids in the two words
+//	at r4.
+//----------------------------------------------------------------------
+
+static void
+SysPipe()
+{
+   int vaddr = machine->ReadRegister(4);
+   Pipe *pipe = new Pipe;
+   int ids[2];
+
+   if (!currentThread->openFiles->AddPipe(pipe, &ids[0], &ids[1])) {
+      printf("[pid %d] Pipe: too many open files\n", currentThread->GetPID());
+      pipe->CloseEnd(FALSE);
+      pipe->CloseEnd(TRUE);
+      delete pipe;
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   ids[0] = WordToMachine(ids[0]);
+   ids[1] = WordToMachine(ids[1]);
+   if (!machine->CopyToUser(vaddr, (char *)ids, 2 * sizeof(int))) {
+      currentThread->openFiles->Close(WordToHost(ids[0]));
+      currentThread->openFiles->Close(WordToHost(ids[1]));
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   WaitForSwapIO();
+   machine->WriteRegister(2, 0);
+}
+
+static void
+SysDup2()
+{
+   machine->WriteRegister(2, currentThread->openFiles->Dup2(machine->ReadRegister(4),
+                                                            machine->ReadRegister(5)));
+}
+
+static void
+SysGetReg()
+{
+   machine->WriteRegister(2, machine->ReadRegister(machine->ReadRegister(4))); // Return value
+}
+
+static void
+SysGetPA()
+{
+   machine->WriteRegister(2, machine->GetPA(machine->ReadRegister(4)));  // Return value
+}
+
+static void
+SysGetPID()
+{
+   machine->WriteRegister(2, currentThread->GetPID());
+}
+
+static void
+SysGetPPID()
+{
+   machine->WriteRegister(2, currentThread->GetPPID());
+}
+
+static void
+SysSleep()
+{
+   unsigned sleeptime = machine->ReadRegister(4);
+
+   if (sleeptime == 0) {
+      // emulate a yield
+      currentThread->Yield();
+   }
+   else {
+      currentThread->SortedInsertInWaitQueue (sleeptime+stats->totalTicks);
+   }
+}
+
+static void
+SysTime()
+{
+   machine->WriteRegister(2, stats->totalTicks);
+}
+
+static void
+SysPrintIntHex()
+{
+   char buffer[16];
+
+   sprintf(buffer, "0x%x", (unsigned)machine->ReadRegister(4));
+   kernelConsole->Write(buffer, strlen(buffer));
+}
+
+static void
+SysNumInstr()
+{
+   machine->WriteRegister(2, currentThread->GetInstructionCount());
+}
+
+static void
+SysPageSize()
+{
+   machine->WriteRegister(2, PageSize);
+}
 
-    }
-    else if ((which == SyscallException) && (type == syscall_Join)) {
-       waitpid = machine->ReadRegister(4);
-       // Check if this is my child. If not, return -1.
-       whichChild = currentThread->CheckIfChild (waitpid);
-       if (whichChild == -1) {
-          printf("[pid %d] Cannot join with non-existent child [pid %d].\n", currentThread->GetPID(), waitpid);
-          machine->WriteRegister(2, -1);
-          // Advance program counters.
-          machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-          machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-          machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-       }
-       else {
-          exitcode = currentThread->JoinWithChild (whichChild);
-          machine->WriteRegister(2, exitcode);
-          // Advance program counters.
-          machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-          machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-          machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-       }
-    }
-    else if ((which == SyscallException) && (type == syscall_Fork)) {
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-       
-       child = new Thread("Forked thread", GET_NICE_FROM_PARENT);
-    	//printf("creating new thread for child\n");
-       child->space = new AddrSpace (currentThread->space);  // Duplicates the address space
-       	//printf("address space for child created\n");
-	child->SaveUserState ();		     		      // Duplicate the register set
-       child->ResetReturnValue ();			     // Sets the return register to zero
-       child->StackAllocate (ForkStartFunction, 0);	// Make it ready for a later context switch
-       child->Schedule ();
-       machine->WriteRegister(2, child->GetPID());		// Return value for parent
-    }
-    else if ((which == SyscallException) && (type == syscall_Yield)) {
-       currentThread->Yield();
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
-    else if ((which == SyscallException) && (type == syscall_PrintInt)) {
-       printval = machine->ReadRegister(4);
-       if (printval == 0) {
-          writeDone->P() ;
-          console->PutChar('0');
-       }
-       else {
-          if (printval < 0) {
-             writeDone->P() ;
-             console->PutChar('-');
-             printval = -printval;
-          }
-          tempval = printval;
-          exp=1;
-          while (tempval != 0) {
-             tempval = tempval/10;
-             exp = exp*10;
-          }
-          exp = exp/10;
-          while (exp > 0) {
-             writeDone->P() ;
-             console->PutChar('0'+(printval/exp));
-             printval = printval % exp;
-             exp = exp/10;
-          }
-       }
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
-    else if ((which == SyscallException) && (type == syscall_PrintChar)) {
-        writeDone->P() ;        // wait for previous write to finish
-        console->PutChar(machine->ReadRegister(4));   // echo it!
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
-    else if ((which == SyscallException) && (type == syscall_PrintString)) {
-        // printf("Line 0\n");
-       vaddr = machine->ReadRegister(4);
-       // printf("Line 1 in PrintString\n");
-       machine->ReadMem(vaddr, 1, &memval);
-       // printf("Line 2\n");
-       while ((*(char*)&memval) != '\0') {
-          writeDone->P() ;
-          console->PutChar(*(char*)&memval);
-          vaddr++;
-          machine->ReadMem(vaddr, 1, &memval);
-          // printf("\nI reached Print_String!\n");
-       }
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
-    else if ((which == SyscallException) && (type == syscall_GetReg)) {
-       machine->WriteRegister(2, machine->ReadRegister(machine->ReadRegister(4))); // Return value
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
-    else if ((which == SyscallException) && (type == syscall_GetPA)) {
-       vaddr = machine->ReadRegister(4);
-       machine->WriteRegister(2, machine->GetPA(vaddr));  // Return value
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
-    else if ((which == SyscallException) && (type == syscall_GetPID)) {
-       machine->WriteRegister(2, currentThread->GetPID());
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
-    else if ((which == SyscallException) && (type == syscall_GetPPID)) {
-       machine->WriteRegister(2, currentThread->GetPPID());
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
-    else if ((which == SyscallException) && (type == syscall_Sleep)) {
-       sleeptime = machine->ReadRegister(4);
-       if (sleeptime == 0) {
-          // emulate a yield
-          currentThread->Yield();
-       }
-       else {
-          currentThread->SortedInsertInWaitQueue (sleeptime+stats->totalTicks);
-       }
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
-    else if ((which == SyscallException) && (type == syscall_Time)) {
-       machine->WriteRegister(2, stats->totalTicks);
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
-    else if ((which == SyscallException) && (type == syscall_PrintIntHex)) {
-       printvalus = (unsigned)machine->ReadRegister(4);
-       writeDone->P() ;
-       console->PutChar('0');
-       writeDone->P() ;
-       console->PutChar('x');
-       if (printvalus == 0) {
-          writeDone->P() ;
-          console->PutChar('0');
-       }
-       else {
-          ConvertIntToHex (printvalus, console);
-       }
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
-    else if ((which == SyscallException) && (type == syscall_NumInstr)) {
-       machine->WriteRegister(2, currentThread->GetInstructionCount());
-       // printf("\nI reached Num_Instr\n");
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
 ///////////////////////// STARTING CHANGES FOR ASSIGNMENT3 ///////////////////////
-    else if((which == SyscallException) && (type == syscall_ShmAllocate)) {
-	size = machine->ReadRegister(4);    
-
-	vaddr = currentThread->space->AllocateSharedMemory(size);
-       
-	machine->WriteRegister(2, vaddr);
-       // Advance program counters.
-       machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-       machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-       machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
+static void
+SysShmAllocate()
+{
+   int size = machine->ReadRegister(4);
+   unsigned vaddr = currentThread->space->AllocateSharedMemory(size);
 
-    else if ((which == SyscallException) && (type == syscall_SemGet))
-    {
-	semKey = machine->ReadRegister(4);
-	for(i=0; i<Sem_size; i++){
-		if(semaphoreKey[i] == semKey){
-			semId = semaphoreId[i];
-			break;
+   WaitForSwapIO();
+   machine->WriteRegister(2, vaddr);
+}
+
+//----------------------------------------------------------------------
+// Futex calls.  The synchronization itself happens in user memory
+// (see test/usync.c); the kernel only parks and wakes threads, and
+// restarts the atomic sequence a thread was interrupted in.
+//----------------------------------------------------------------------
+
+static void
+SysFutexWait()
+{
+   int result = FutexWait(machine->ReadRegister(4), machine->ReadRegister(5));
+
+   WaitForSwapIO();				// the word may have been paged in
+   machine->WriteRegister(2, result);
+}
+
+static void
+SysFutexWake()
+{
+   int result = FutexWake(machine->ReadRegister(4), machine->ReadRegister(5));
+
+   WaitForSwapIO();
+   machine->WriteRegister(2, result);
+}
+
+static void
+SysSetAtomicRegion()
+{
+   int start = machine->ReadRegister(4);
+   int end = machine->ReadRegister(5);
+
+   if ((start < 0) || (end < start) || ((start & 3) != 0) || ((end & 3) != 0) ||
+       ((unsigned)end > currentThread->space->GetNumPages() * PageSize)) {
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   currentThread->space->SetAtomicRegion(start, end);
+   machine->WriteRegister(2, 0);
+}
+
+static void
+SysMemStat()
+{
+   int memStats[NUM_MEM_STATS];
+   int vaddr = machine->ReadRegister(4);
+   int i;
+
+   currentThread->space->GetMemStats(memStats);
+   for (i=0; i<NUM_MEM_STATS; i++) memStats[i] = WordToMachine(memStats[i]);
+   if (machine->CopyToUser(vaddr, (char *)memStats, sizeof(memStats)))
+      machine->WriteRegister(2, 0);
+   else
+      machine->WriteRegister(2, -1);
+   WaitForSwapIO();				// writing may have faulted pages in
+}
+
+//----------------------------------------------------------------------
+// SysRingSetup, SysRingEnter
+// 	Asynchronous system calls, see asyncring.h.
+//----------------------------------------------------------------------
+
+static void
+SysRingSetup()
+{
+   int entries = machine->ReadRegister(4);
+   int dataSize = machine->ReadRegister(5);
+
+   if (currentThread->ring == NULL)
+      currentThread->ring = SetupAsyncRing(entries, dataSize);
+   else {
+      printf("[pid %d] RingSetup: ring already set up\n", currentThread->GetPID());
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   WaitForSwapIO();
+   if (currentThread->ring == NULL) machine->WriteRegister(2, -1);
+   else machine->WriteRegister(2, currentThread->ring->GetAddress());
+}
+
+static void
+SysRingEnter()
+{
+   int minComplete = machine->ReadRegister(4);
+
+   if (currentThread->ring == NULL) {
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   currentThread->ring->Enter();
+   machine->WriteRegister(2, currentThread->ring->WaitForCompletions(minComplete));
+}
+
+static void
+SysSetMemLimit()
+{
+   int pages = machine->ReadRegister(4);
+
+   if ((pages > 0) && (replacementAlgo == 0)) {	// nothing could be replaced
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   currentThread->space->SetResidentLimit((pages > 0) ? pages : 0);	// 0: no limit
+   machine->WriteRegister(2, 0);
+}
+
+static void
+SysSemGet()
+{
+   int semKey = machine->ReadRegister(4);
+   int semId = semaphoreTable->Find(semKey);
+   Semaphore *sem;
+
+	if (semId == -1) {
+		sem = new Semaphore("Sem_name", 1);
+		semId = semaphoreTable->Add(semKey, sem);
+		if (semId == -1) {
+			printf("ERROR: The total number of semaphores has exceeded the allowed limit.\n Semaphore could not be created, function returns -1\n");
+			delete sem;
 		}
 	}
-	if(Sem_size >= MAX_SEMAPHORES){
-		printf("ERROR: The total number of semaphores has exceeded the allowed limit.\n Semaphore could not be created, function returns -1\n");
-		semId = -1; //The return value corresponding to return
-	}
-	if(( i == Sem_size) && (Sem_size < MAX_SEMAPHORES)) {
-		IntStatus oldLevel = interrupt->SetLevel(IntOff); //disable interrupts
-	
-		semaphoreKey[Sem_size] = semKey;
-		semaphoreId[Sem_size] = Id_counter;
-		semaphores[Sem_size] = new Semaphore("Sem_name", 1);
-		semId = semaphoreId[Sem_size];
-		Sem_size++;
-		Id_counter++;
-	
-		(void) interrupt->SetLevel(oldLevel); //enable interrupts
-    	}
-	// Advance program counters.
-	machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-	machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-	machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-	
 	// Return the Semaphore ID
 	machine->WriteRegister(2, semId);
-    }
-	
-    else if ((which == SyscallException) && (type == syscall_SemOp))
-    {
-	semId = machine->ReadRegister(4);
-	adjustment_value = machine->ReadRegister(5);
-	for(i =0; i<Sem_size; i++){
-		if(semaphoreId[i] == semId){
-			semId = i;
-			break;
-		}
-	}
-	if(i == Sem_size){
+}
+
+//----------------------------------------------------------------------
+// LookupSemaphore
+// 	Return the semaphore with id "semId", or NULL if there is none.
+//	Also used by asynchronous SemOp requests.
+//----------------------------------------------------------------------
+
+Semaphore *
+LookupSemaphore(int semId)
+{
+   return (Semaphore *)semaphoreTable->Lookup(semId);
+}
+
+static void
+SysSemOp()
+{
+   Semaphore *sem = LookupSemaphore(machine->ReadRegister(4));
+   int adjustment_value = machine->ReadRegister(5);
+
+	if(sem == NULL){
 		printf("ERROR: The semaphore id entered is not a valid id\n");
 	}
 	else {
 		if(adjustment_value == -1){
-			semaphores[semId]->P();
+			sem->P();
 		}
 		else if(adjustment_value == 1){
-			semaphores[semId]->V();
+			sem->V();
 		}
 		else {
 			printf("ERROR: Invalid Operation id in syscall_SemOp\n");
 		}
 	}
-	// Advance program counters.
-	machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-	machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-	machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-	
-	// Return the Semaphore ID
-	//machine->WriteRegister(2, semId);
-    }
-	
-    else if ((which == SyscallException) && (type == syscall_SemCtl))
-    {
-	//printf("qqqqqqqqqqqqqqqqqqqqqq entered\n");
-	semId = machine->ReadRegister(4);
-	adjustment_value = machine->ReadRegister(5);
-	vaddr = machine->ReadRegister(6);
-	
-	for (i=0; i<Sem_size; i++){
-		if(semaphoreId[i] == semId){
-			semId = i;
-			break;
-		}
-	}
-	if (i == Sem_size) {
+}
+
+static void
+SysSemCtl()
+{
+   int semId = machine->ReadRegister(4);
+   int adjustment_value = machine->ReadRegister(5);
+   int vaddr = machine->ReadRegister(6);
+   Semaphore *sem = LookupSemaphore(semId);
+   int value, exitcode;
+
+	if (sem == NULL) {
 		exitcode = -1;
 	}
 	else if(adjustment_value == SYNCH_REMOVE){
-		delete semaphores[semId];
-		for(i=semId; i<Sem_size-1; i++){
-			semaphores[i] = semaphores[i+1]; //deleting semaphore
-			semaphoreKey[i] = semaphoreKey[i+1]; //removing from mapping
-			semaphoreId[i] = semaphoreId[i+1];
-		}
-		Sem_size--;
+		semaphoreTable->Remove(semId);	// the id is stale from now on
+		delete sem;
 		exitcode = 0;
 	}
 	else if(adjustment_value == SYNCH_GET) {
-		PhyAddr = machine->GetPA(vaddr);
-		if(PhyAddr == -1){
-			exitcode = -1;
-		}
-		else {
-			machine->mainMemory[PhyAddr] = semaphores[semId]->getValue();
+		value = WordToMachine(sem->getValue());
+		if (machine->CopyToUser(vaddr, (char *)&value, sizeof(int)))
 			exitcode = 0;
-		}
+		else
+			exitcode = -1;
 	}
 	else if(adjustment_value == SYNCH_SET) {
-		PhyAddr = machine->GetPA(vaddr);
-		//printf("reached a correct destination before segmentation fault\n");
-		if(PhyAddr == -1){
-			exitcode = -1;
-		}
-		else {
-			//printf("intPointer is also not null, baby we are going to rock the world");
-			semaphores[semId]->setValue(machine->mainMemory[PhyAddr]);
+		if (machine->CopyFromUser(vaddr, (char *)&value, sizeof(int))) {
+			sem->setValue(WordToHost(value));
 			exitcode = 0;
 		}
+		else
+			exitcode = -1;
 	}
 	else {
-		//printf("The adjustment value was not a valid value");
 		exitcode = -1;
 	}
-	//printf("aaaaaaaaaaaaaaaaaaaaaaaaaaaa successful completion\n");
-	// Advance program counters.
-	machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-	machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-	machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-	
-	// Return the Semaphore ID
 	machine->WriteRegister(2, exitcode);
-    }
- 
-    else if ((which == SyscallException) && (type == syscall_CondGet))
-    {
-	condKey = machine->ReadRegister(4);
-	for(i=0; i<Cond_size; i++){
-		if(conditionKey[i] == condKey){
-			condId = conditionId[i];
-			break;
+}
+
+//----------------------------------------------------------------------
+// Semaphore set calls, see semset.h.  Sets are registered in
+// semSetTable the same way semaphores are.
+//----------------------------------------------------------------------
+
+static void
+SysSemSetGet()
+{
+   int key = machine->ReadRegister(4);
+   int size = machine->ReadRegister(5);
+   int setId = semSetTable->Find(key);
+   SemaphoreSet *set;
+
+   if (setId != -1) {			// must not ask for more than it has
+      set = (SemaphoreSet *)semSetTable->Lookup(setId);
+      if (size > set->GetSize()) setId = -1;
+   }
+   else if ((size > 0) && (size <= MAX_SEMSET_SIZE)) {
+      set = new SemaphoreSet(size);
+      setId = semSetTable->Add(key, set);
+      if (setId == -1) delete set;
+   }
+   machine->WriteRegister(2, setId);
+}
+
+static void
+SysSemOpMulti()
+{
+   SemaphoreSet *set = (SemaphoreSet *)semSetTable->Lookup(machine->ReadRegister(4));
+   int vaddr = machine->ReadRegister(5);
+   int count = machine->ReadRegister(6);
+   int flags = machine->ReadRegister(7);
+   SemBuf ops[MAX_SEMSET_OPS];
+   bool copied;
+   int i;
+
+   if ((set == NULL) || (count <= 0) || (count > MAX_SEMSET_OPS)) {
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   copied = machine->CopyFromUser(vaddr, (char *)ops, count * sizeof(SemBuf));
+   WaitForSwapIO();				// the copy may have faulted
+   if (!copied) {
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   for (i = 0; i < count; i++) {
+      ops[i].num = WordToHost(ops[i].num);
+      ops[i].adjustment = WordToHost(ops[i].adjustment);
+      if ((ops[i].num < 0) || (ops[i].num >= set->GetSize())) {
+         machine->WriteRegister(2, -1);
+         return;
+      }
+   }
+   if (set->Operate(ops, count, (flags & SEM_NOWAIT) != 0))
+      machine->WriteRegister(2, 0);
+   else
+      machine->WriteRegister(2, -1);
+}
+
+static void
+SysSemSetCtl()
+{
+   int setId = machine->ReadRegister(4);
+   int command = machine->ReadRegister(5);
+   int num = machine->ReadRegister(6);
+   int vaddr = machine->ReadRegister(7);
+   SemaphoreSet *set = (SemaphoreSet *)semSetTable->Lookup(setId);
+   int value, result = -1;
+
+   if (set == NULL) {
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   if (command == SYNCH_REMOVE) {
+      if (!set->IsBusy()) {		// sleepers would wake in freed memory
+         semSetTable->Remove(setId);
+         delete set;
+         result = 0;
+      }
+   }
+   else if ((num < 0) || (num >= set->GetSize())) {
+      result = -1;
+   }
+   else if (command == SYNCH_GET) {
+      value = WordToMachine(set->GetValue(num));
+      if (machine->CopyToUser(vaddr, (char *)&value, sizeof(int))) result = 0;
+   }
+   else if (command == SYNCH_SET) {
+      if (machine->CopyFromUser(vaddr, (char *)&value, sizeof(int))) {
+         set->SetValue(num, WordToHost(value));
+         result = 0;
+      }
+   }
+   WaitForSwapIO();
+   machine->WriteRegister(2, result);
+}
+
+static void
+SysCondGet()
+{
+   int condKey = machine->ReadRegister(4);
+   int condId = conditionTable->Find(condKey);
+   Condition *cond;
+
+	if (condId == -1) {
+		cond = new Condition("Cond_name");
+		condId = conditionTable->Add(condKey, cond);
+		if (condId == -1) {
+			printf("ERROR: The total number of conditions has exceeded the allowed limit.\n Condition Variable could not be created, function returns -1\n");
+			delete cond;
 		}
 	}
-	if(Cond_size >= MAX_CONDITIONS){
-		printf("ERROR: The total number of conditions has exceeded the allowed limit.\n Condition Variable could not be created, function returns -1\n");
-		condId = -1; //The return value corresponding to return
-	}
-	if(( i == Cond_size) && (Cond_size < MAX_CONDITIONS)) {
-		IntStatus oldLevel = interrupt->SetLevel(IntOff); //disable interrupts
-	
-		conditionKey[Cond_size] = condKey;
-		conditionId[Cond_size] = CondId_counter;
-		conditions[Cond_size] = new Condition("Cond_name");
-		condId = conditionId[Cond_size];
-		Cond_size++;
-		CondId_counter++;
-	
-		(void) interrupt->SetLevel(oldLevel); //enable interrupts
-    	}
-	// Advance program counters.
-	machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-	machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-	machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-	
-	// Return the Semaphore ID
 	machine->WriteRegister(2, condId);
-    }
+}
 
-    else if ((which == SyscallException) && (type == syscall_CondOp))
-    {
-	condId = machine->ReadRegister(4);
-	adjustment_value = machine->ReadRegister(5);
-	semId = machine->ReadRegister(6);
-	
-	for(i =0; i<Cond_size; i++){
-		if(conditionId[i] == condId){
-			condId = i;
-			break;
-		}
-	}
-	if(i == Cond_size){
+static void
+SysCondOp()
+{
+   Condition *cond = (Condition *)conditionTable->Lookup(machine->ReadRegister(4));
+   int adjustment_value = machine->ReadRegister(5);
+   Semaphore *sem = LookupSemaphore(machine->ReadRegister(6));
+
+	if(cond == NULL){
 		printf("ERROR: The condition variable id entered is not a valid id\n");
 	}
+	else if(sem == NULL){
+		printf("ERROR: The semaphore id entered is not a valid id\n");
+	}
 	else {
-		for(i =0; i<Sem_size; i++){
-			if(semaphoreId[i] == semId){
-				semId = i;
-				break;
-			}
+		if(adjustment_value == COND_OP_WAIT){
+			cond->Wait(sem);
 		}
-		if(i == Sem_size){
-			printf("ERROR: The semaphore id entered is not a valid id\n");
+		else if(adjustment_value == COND_OP_SIGNAL){
+			cond->Signal();
+		}
+		else if(adjustment_value == COND_OP_BROADCAST){
+			cond->Broadcast();
 		}
 		else {
-			if(adjustment_value == COND_OP_WAIT){
-				//printf("Before calling internal function\n");
-				conditions[condId]->Wait(semaphores[semId]);
-				//printf("after the same\n");
-			}
-			else if(adjustment_value == COND_OP_SIGNAL){
-				conditions[condId]->Signal();
-			}
-			else if(adjustment_value == COND_OP_BROADCAST){
-				conditions[condId]->Broadcast();
-			}
-			else {
-				printf("ERROR: Invalid operation in syscall_CondOp");
-			}
+			printf("ERROR: Invalid operation in syscall_CondOp");
 		}
 	}
-	// Advance program counters.
-	machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-	machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-	machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-	
-	// Return the Semaphore ID
-	//machine->WriteRegister(2, semId);
-    }
+}
 
-    else if ((which == SyscallException) && (type == syscall_CondRemove))
-    {
-	//printf("qqqqqqqqqqqqqqqqqqqqqq entered\n");
-	condId = machine->ReadRegister(4);
-//	adjustment_value = machine->ReadRegister(5);
-//	vaddr = machine->ReadRegister(6);
-	
-	for (i=0; i<Cond_size; i++){
-		if(conditionId[i] == condId){
-			condId = i;
-			break;
-		}
-	}
-	if (i == Cond_size) {
-		exitcode = -1;
-	}
-	else {
-		delete conditions[condId];
-		for(i=condId; i<Cond_size-1; i++){
-			conditions[i] = conditions[i+1]; //deleting condiion variable
-			conditionKey[i] = conditionKey[i+1]; //removing from mapping
-			conditionId[i] = conditionId[i+1];
-		}
-		Cond_size--;
-		exitcode = 0;
-	}
-	//printf("aaaaaaaaaaaaaaaaaaaaaaaaaaaa successful completion\n");
-	// Advance program counters.
-	machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-	machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-	machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-	
-	// Return the Semaphore ID
-	machine->WriteRegister(2, exitcode);
-    }
+static void
+SysCondRemove()
+{
+   Condition *cond = (Condition *)conditionTable->Remove(machine->ReadRegister(4));
 
-    /*
-    *	PAGE FAULT Exception
-    *
-    *	Yeh wala comment aise hi dala hai, mujhe ek baar mein dikhta hi nahi ki 
-    *	Page Fault Exception kahan se shuru ho raha hai
-    */
-    else if (which == PageFaultException)       
-    {
-        
-        stats->numPageFaults++;
-        TranslationEntry *entry;
-        va = machine->ReadRegister(BadVAddrReg);
-        vpn = va/PageSize;									// akg:: Problem solved!! BadVAddrReg returns the virtual address, not the page number; I can't believe we realised it that late
-
-        printf("vpn = %d\n",vpn);
-        TranslationEntry* pageTable = currentThread->space->GetPageTable();
-        
-        entry = &pageTable[vpn];
-        i = 0;
-        while (PhyPageIsAllocated[i] == TRUE)
-        {
-           i++;
-        }
-        
-        printf("i = %d\n",i);
-
-        if (i == NumPhysPages)								// Entry to this 'if' marks a page replacement
-        {
-        	if (replacementAlgo != 0)
-        	{
-        		i = PageReplacement();
-        	}
-        	else {
-            	ASSERT(FALSE);
-            }
-        }
-        entry->virtualPage = vpn;
-        entry->physicalPage = i;
-        entry->valid = TRUE;
-        PhyPageIsAllocated[i] = TRUE;
-
-        bzero(&machine->mainMemory[numPagesAllocated*PageSize], PageSize);
-
-        numPagesAllocated++;
-        currentThread->space->CopyContent(entry->physicalPage, vpn);
-       // currentThread->SortedInsertInWaitQueue(stats->totalTicks+10);
-        // machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
-        // machine->WriteRegister(PCReg, machine->ReadRegister(NextPCReg));
-        // machine->WriteRegister(NextPCReg, machine->ReadRegister(NextPCReg)+4);
-    }
+	if (cond != NULL) delete cond;
+	machine->WriteRegister(2, (cond != NULL) ? 0 : -1);
+}
 
- 
-//////////////////////////// DONE CHANGES IN ASSIGNMENT 3 /////////////////////////////////////
+static void
+SysRWLockGet()
+{
+   int key = machine->ReadRegister(4);
+   int rwId = rwLockTable->Find(key);
+   RWLock *rw;
+
+   if (rwId == -1) {
+      rw = new RWLock("RWLock_name");
+      rwId = rwLockTable->Add(key, rw);
+      if (rwId == -1) delete rw;
+   }
+   machine->WriteRegister(2, rwId);
+}
+
+static void
+SysRWLockOp()
+{
+   RWLock *rw = (RWLock *)rwLockTable->Lookup(machine->ReadRegister(4));
+   int op = machine->ReadRegister(5);
+   int result = 0;
+
+   if (rw == NULL) result = -1;
+   else if (op == RWLOCK_OP_READ) {
+      if (rw->isWriteHeldByCurrentThread()) result = -1;
+      else rw->AcquireRead();
+   }
+   else if (op == RWLOCK_OP_WRITE) {
+      if (rw->isWriteHeldByCurrentThread() || rw->isReadHeldByCurrentThread())
+         result = -1;			// would wait for ourselves
+      else rw->AcquireWrite();
+   }
+   else if (op == RWLOCK_OP_UNLOCK) {
+      if (!rw->isWriteHeldByCurrentThread() && !rw->isReadHeldByCurrentThread())
+         result = -1;			// not ours to release
+      else rw->Release();
+   }
+   else result = -1;
+   machine->WriteRegister(2, result);
+}
+
+static void
+SysRWLockRemove()
+{
+   int rwId = machine->ReadRegister(4);
+   RWLock *rw = (RWLock *)rwLockTable->Lookup(rwId);
 
-  else {
-	printf("Unexpected user mode exception %d %d\n", which, type);
-	ASSERT(FALSE);
+   if ((rw == NULL) || rw->isBusy()) {
+      machine->WriteRegister(2, -1);
+      return;
    }
+   rwLockTable->Remove(rwId);
+   delete rw;
+   machine->WriteRegister(2, 0);
+}
+
+static void
+SysBarrierGet()
+{
+   int key = machine->ReadRegister(4);
+   int count = machine->ReadRegister(5);
+   int barrierId = barrierTable->Find(key);
+   Barrier *barrier;
+
+   if (barrierId != -1) {		// everybody must agree on the count
+      barrier = (Barrier *)barrierTable->Lookup(barrierId);
+      if (barrier->getCount() != count) barrierId = -1;
+   }
+   else if (count > 0) {
+      barrier = new Barrier("Barrier_name", count);
+      barrierId = barrierTable->Add(key, barrier);
+      if (barrierId == -1) delete barrier;
+   }
+   machine->WriteRegister(2, barrierId);
+}
+
+static void
+SysBarrierWait()
+{
+   Barrier *barrier = (Barrier *)barrierTable->Lookup(machine->ReadRegister(4));
+
+   if (barrier == NULL) machine->WriteRegister(2, -1);
+   else machine->WriteRegister(2, barrier->Wait() ? 1 : 0);
+}
+
+static void
+SysBarrierRemove()
+{
+   int barrierId = machine->ReadRegister(4);
+   Barrier *barrier = (Barrier *)barrierTable->Lookup(barrierId);
+
+   if ((barrier == NULL) || (barrier->getWaiting() > 0)) {
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   barrierTable->Remove(barrierId);
+   delete barrier;
+   machine->WriteRegister(2, 0);
+}
+
+static void
+SysMsgQueueGet()
+{
+   int key = machine->ReadRegister(4);
+   int capacity = machine->ReadRegister(5);
+   int queueId = msgQueueTable->Find(key);
+   MessageQueue *queue;
+
+   if ((queueId == -1) && (capacity > 0) && (capacity <= MAX_MSG_QUEUE_LENGTH)) {
+      queue = new MessageQueue(capacity);
+      queueId = msgQueueTable->Add(key, queue);
+      if (queueId == -1) delete queue;
+   }
+   machine->WriteRegister(2, queueId);
+}
+
+static void
+SysMsgSend()
+{
+   MessageQueue *queue = (MessageQueue *)msgQueueTable->Lookup(machine->ReadRegister(4));
+   int vaddr = machine->ReadRegister(5);
+   int size = machine->ReadRegister(6);
+   bool sent;
+
+   if ((queue == NULL) || (size < 0) || (size > MAX_MSG_SIZE)) {
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   sent = queue->Send(vaddr, size);
+   WaitForSwapIO();				// the copy may have faulted
+   machine->WriteRegister(2, sent ? 0 : -1);
+}
+
+static void
+SysMsgReceive()
+{
+   MessageQueue *queue = (MessageQueue *)msgQueueTable->Lookup(machine->ReadRegister(4));
+   int vaddr = machine->ReadRegister(5);
+   int size = machine->ReadRegister(6);
+   int result;
+
+   if (queue == NULL) {
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   result = queue->Receive(vaddr, size);
+   WaitForSwapIO();
+   machine->WriteRegister(2, result);
+}
+
+static void
+SysMsgQueueRemove()
+{
+   int queueId = machine->ReadRegister(4);
+   MessageQueue *queue = (MessageQueue *)msgQueueTable->Lookup(queueId);
+
+   if ((queue == NULL) || queue->IsBusy()) {
+      machine->WriteRegister(2, -1);
+      return;
+   }
+   msgQueueTable->Remove(queueId);
+   delete queue;
+   machine->WriteRegister(2, 0);
+}
+
+//----------------------------------------------------------------------
+// The system call table.  syscallList names every system call; it is
+// turned into syscallTable, indexed by system call code, when Nachos
+// starts.
+//----------------------------------------------------------------------
+
+typedef void (*SyscallHandler)();
+
+// Whether a call may be part of a sys_Batch.  Calls that can block,
+// that do not return, or that change the address space may not.
+enum BatchClass {
+   BATCH_NO,				// must be a trap of its own
+   BATCH_VALUE,				// always succeeds
+   BATCH_STATUS				// a negative result is a failure
+};
+
+struct SyscallEntry {
+   int code;				// syscall_* from syscall.h
+   char *name;
+   SyscallHandler handler;
+   BatchClass batch;
+};
+
+static void SysBatch();
+
+static SyscallEntry syscallList[] = {
+   { syscall_Halt,		"Halt",		SysHalt,	BATCH_NO },
+   { syscall_Exit,		"Exit",		SysExit,	BATCH_NO },
+   { syscall_Exec,		"Exec",		SysExec,	BATCH_NO },
+   { syscall_Join,		"Join",		SysJoin,	BATCH_NO },
+   { syscall_Spawn,		"Spawn",	SysSpawn,	BATCH_NO },
+   { syscall_Create,		"Create",	SysCreate,	BATCH_NO },
+   { syscall_Open,		"Open",		SysOpen,	BATCH_NO },
+   { syscall_Read,		"Read",		SysRead,	BATCH_NO },
+   { syscall_Write,		"Write",	SysWrite,	BATCH_STATUS },
+   { syscall_Close,		"Close",	SysClose,	BATCH_NO },
+   { syscall_Fork,		"Fork",		SysFork,	BATCH_NO },
+   { syscall_Yield,		"Yield",	SysYield,	BATCH_NO },
+   { syscall_PrintInt,		"PrintInt",	SysPrintInt,	BATCH_VALUE },
+   { syscall_PrintChar,		"PrintChar",	SysPrintChar,	BATCH_VALUE },
+   { syscall_PrintString,	"PrintString",	SysPrintString,	BATCH_VALUE },
+   { syscall_GetReg,		"GetReg",	SysGetReg,	BATCH_NO },
+   { syscall_GetPA,		"GetPA",	SysGetPA,	BATCH_VALUE },
+   { syscall_GetPID,		"GetPID",	SysGetPID,	BATCH_VALUE },
+   { syscall_GetPPID,		"GetPPID",	SysGetPPID,	BATCH_VALUE },
+   { syscall_Sleep,		"Sleep",	SysSleep,	BATCH_NO },
+   { syscall_Time,		"Time",		SysTime,	BATCH_VALUE },
+   { syscall_PrintIntHex,	"PrintIntHex",	SysPrintIntHex,	BATCH_VALUE },
+   { syscall_SemGet,		"SemGet",	SysSemGet,	BATCH_STATUS },
+   { syscall_SemOp,		"SemOp",	SysSemOp,	BATCH_VALUE },
+   { syscall_SemCtl,		"SemCtl",	SysSemCtl,	BATCH_STATUS },
+   { syscall_CondGet,		"CondGet",	SysCondGet,	BATCH_STATUS },
+   { syscall_CondOp,		"CondOp",	SysCondOp,	BATCH_NO },
+   { syscall_CondRemove,	"CondRemove",	SysCondRemove,	BATCH_STATUS },
+   { syscall_ShmAllocate,	"ShmAllocate",	SysShmAllocate,	BATCH_NO },
+   { syscall_MemStat,		"MemStat",	SysMemStat,	BATCH_STATUS },
+   { syscall_SetMemLimit,	"SetMemLimit",	SysSetMemLimit,	BATCH_STATUS },
+   { syscall_RingSetup,		"RingSetup",	SysRingSetup,	BATCH_NO },
+   { syscall_RingEnter,		"RingEnter",	SysRingEnter,	BATCH_NO },
+   { syscall_Batch,		"Batch",	SysBatch,	BATCH_NO },
+   { syscall_FutexWait,		"FutexWait",	SysFutexWait,	BATCH_NO },
+   { syscall_FutexWake,		"FutexWake",	SysFutexWake,	BATCH_VALUE },
+   { syscall_SetAtomicRegion,	"SetAtomicRegion", SysSetAtomicRegion, BATCH_STATUS },
+   { syscall_SemSetGet,		"SemSetGet",	SysSemSetGet,	BATCH_STATUS },
+   { syscall_SemOpMulti,	"SemOpMulti",	SysSemOpMulti,	BATCH_NO },
+   { syscall_SemSetCtl,		"SemSetCtl",	SysSemSetCtl,	BATCH_STATUS },
+   { syscall_RWLockGet,		"RWLockGet",	SysRWLockGet,	BATCH_STATUS },
+   { syscall_RWLockOp,		"RWLockOp",	SysRWLockOp,	BATCH_NO },
+   { syscall_RWLockRemove,	"RWLockRemove",	SysRWLockRemove, BATCH_STATUS },
+   { syscall_BarrierGet,	"BarrierGet",	SysBarrierGet,	BATCH_STATUS },
+   { syscall_BarrierWait,	"BarrierWait",	SysBarrierWait,	BATCH_NO },
+   { syscall_BarrierRemove,	"BarrierRemove", SysBarrierRemove, BATCH_STATUS },
+   { syscall_MsgQueueGet,	"MsgQueueGet",	SysMsgQueueGet,	BATCH_STATUS },
+   { syscall_MsgSend,		"MsgSend",	SysMsgSend,	BATCH_NO },
+   { syscall_MsgReceive,	"MsgReceive",	SysMsgReceive,	BATCH_NO },
+   { syscall_MsgQueueRemove,	"MsgQueueRemove", SysMsgQueueRemove, BATCH_STATUS },
+   { syscall_Pipe,		"Pipe",		SysPipe,	BATCH_NO },
+   { syscall_Dup2,		"Dup2",		SysDup2,	BATCH_STATUS },
+   { syscall_PageSize,		"PageSize",	SysPageSize,	BATCH_VALUE },
+   { syscall_NumInstr,		"NumInstr",	SysNumInstr,	BATCH_VALUE },
+};
+
+#define NUM_SYSCALL_ENTRIES	(int)(sizeof(syscallList) / sizeof(SyscallEntry))
+
+static SyscallEntry *syscallTable[MAX_SYSCALL_CODE + 1];	// NULL: no such call
+
+//----------------------------------------------------------------------
+// InitializeSyscalls
+// 	Build the system call table.  Called once, from Initialize.
+//----------------------------------------------------------------------
+
+void
+InitializeSyscalls()
+{
+   int i;
+
+   for (i = 0; i <= MAX_SYSCALL_CODE; i++) syscallTable[i] = NULL;
+   for (i = 0; i < NUM_SYSCALL_ENTRIES; i++) {
+      ASSERT((syscallList[i].code >= 0) && (syscallList[i].code <= MAX_SYSCALL_CODE));
+      ASSERT(syscallTable[syscallList[i].code] == NULL);
+      syscallTable[syscallList[i].code] = &syscallList[i];
+   }
+}
+
+//----------------------------------------------------------------------
+// SyscallName
+// 	Name of call "code", for printing statistics.
+//----------------------------------------------------------------------
+
+char *
+SyscallName(int code)
+{
+   if ((code < 0) || (code > MAX_SYSCALL_CODE) || (syscallTable[code] == NULL))
+      return NULL;
+   return syscallTable[code]->name;
+}
+
+//----------------------------------------------------------------------
+// MeasuredSyscall
+// 	Run the handler of "entry" and tell syscallStats about it.  The
+//	arguments are saved first, since handlers may change r4..r7.
+//----------------------------------------------------------------------
+
+static void
+MeasuredSyscall(SyscallEntry *entry)
+{
+   int pid = currentThread->GetPID();
+   int args[4], i, startTicks;
+   unsigned startHost;
+
+   for (i = 0; i < 4; i++) args[i] = machine->ReadRegister(4 + i);
+   syscallStats->CallStarted(pid, entry->code, args);
+   startTicks = stats->totalTicks;
+   startHost = HostMicroseconds();
+
+   (*entry->handler)();			// may block, or not return at all
+
+   syscallStats->CallFinished(pid, entry->code, machine->ReadRegister(2),
+                              stats->totalTicks - startTicks,
+                              HostMicroseconds() - startHost);
+}
+
+//----------------------------------------------------------------------
+// PrintedLength
+// 	Number of bytes SysPrintString would print for the string at
+//	"vaddr".  We stop counting once we are past "limit".
+//----------------------------------------------------------------------
+
+static int
+PrintedLength(int vaddr, int limit)
+{
+   char buffer[PRINT_CHUNK];
+   int total = 0, length;
+
+   do {
+      length = machine->CopyStringFromUser(vaddr + total, buffer, PRINT_CHUNK);
+      if (length > 0) total += length;
+   } while ((length == PRINT_CHUNK) && (total <= limit));
+   return total;
+}
+
+//----------------------------------------------------------------------
+// BatchWouldBlock
+// 	TRUE if the batched call in "record" might have to wait: a P on a
+//	semaphore at zero, a Read, a Write to anything but the console (a
+//	disk file, or a pipe end, which waits while the pipe is full), or
+//	console output that does not fit in what is free of the kernel's
+//	buffer.
+//----------------------------------------------------------------------
+
+static bool
+BatchWouldBlock(SyscallEntry *entry, int *record)
+{
+   int room = kernelConsole->FreeSpace();
+   char buffer[16];
+   Semaphore *sem;
+
+   if ((entry->code == syscall_SemOp) && (record[2] == -1)) {
+      sem = LookupSemaphore(record[1]);
+      return (sem != NULL) && (sem->getValue() == 0);
+   }
+   if (entry->code == syscall_Read) return TRUE;	// keyboard, disk or pipe
+   if (entry->code == syscall_Write) {
+      if ((record[3] != ConsoleOutput) || !currentThread->openFiles->IsConsole(record[3]))
+         return TRUE;				// disk file or pipe end
+      return record[2] > room;
+   }
+   if (entry->code == syscall_PrintChar) return room < 1;
+   if (entry->code == syscall_PrintInt)
+      return sprintf(buffer, "%d", record[1]) > room;
+   if (entry->code == syscall_PrintIntHex)
+      return sprintf(buffer, "0x%x", (unsigned)record[1]) > room;
+   if (entry->code == syscall_PrintString)
+      return PrintedLength(record[1], room) > room;
+   return FALSE;
+}
+
+//----------------------------------------------------------------------
+// SysBatch
+// 	Run the BatchRecords at r4 one after the other, in this kernel
+//	entry.  Each record's arguments are put in r4..r7 and its handler
+//	is called as if the program had trapped; r2 goes back into the
+//	record.  We stop at a record that is not valid, whose call may
+//	not be batched or would block, or that fails; r2 gets the number
+//	of records that completed.
+//----------------------------------------------------------------------
+
+static void
+SysBatch()
+{
+   int vaddr = machine->ReadRegister(4);
+   int count = machine->ReadRegister(5);
+   int record[BATCH_RECORD_WORDS];
+   SyscallEntry *entry;
+   int done, i, addr, result;
+
+   if (count > MAX_BATCH_RECORDS) count = MAX_BATCH_RECORDS;
+   for (done = 0; done < count; done++) {
+      addr = vaddr + done * (int)sizeof(record);
+      if (!machine->CopyFromUser(addr, (char *)record, sizeof(record))) break;
+      for (i = 0; i < BATCH_RECORD_WORDS; i++) record[i] = WordToHost(record[i]);
+
+      if ((record[0] < 0) || (record[0] > MAX_SYSCALL_CODE)) break;
+      entry = syscallTable[record[0]];
+      if ((entry == NULL) || (entry->batch == BATCH_NO)) break;
+      if (BatchWouldBlock(entry, record)) break;
+
+      for (i = 0; i < 4; i++) machine->WriteRegister(4 + i, record[1 + i]);
+      machine->WriteRegister(2, 0);
+      (*entry->handler)();
+      result = machine->ReadRegister(2);
+      record[5] = WordToMachine(result);
+      if (!machine->CopyToUser(addr + 5 * sizeof(int), (char *)&record[5], sizeof(int)))
+         break;
+      if ((entry->batch == BATCH_STATUS) && (result < 0)) break;
+   }
+   WaitForSwapIO();				// the copies may have faulted
+   DEBUG('a', "Batch of %d calls, %d completed\n", count, done);
+   machine->WriteRegister(2, done);
+}
+
+//----------------------------------------------------------------------
+// PageFaultHandler
+// 	Bring the missing page in, then let the instruction run again.
+//----------------------------------------------------------------------
+
+static void
+PageFaultHandler()
+{
+   int faultStart = stats->totalTicks;
+   unsigned vpn = (unsigned)machine->ReadRegister(BadVAddrReg) / PageSize;	// BadVAddrReg holds
+											// the address, not the page
+   stats->numPageFaults++;
+   printf("vpn = %d\n",vpn);
+   currentThread->space->PageIn(vpn);		// may replace another page
+   printf("i = %d\n", currentThread->space->GetPageTable()[vpn].physicalPage);
+
+   WaitForSwapIO();					// sleep while the swap transfers complete
+   stats->faultServiceTicks += stats->totalTicks - faultStart;
+}
+
+//----------------------------------------------------------------------
+// ReadOnlyHandler
+// 	Write to a read-only page.  The only read-only pages are the ones
+//	merged by the page merge daemon; give the writer its own copy.
+//----------------------------------------------------------------------
+
+static void
+ReadOnlyHandler()
+{
+   unsigned vpn = (unsigned)machine->ReadRegister(BadVAddrReg) / PageSize;
+   TranslationEntry* pageTable = currentThread->space->GetPageTable();
+
+   if (!pageTable[vpn].cow) {
+      printf("[pid %d] Write to read-only page %d\n", currentThread->GetPID(), vpn);
+      ASSERT(FALSE);
+   }
+   BreakCopyOnWrite(&pageTable[vpn]);
+   currentThread->space->CountMinorFault();
+   WaitForSwapIO();
+}
+
+//----------------------------------------------------------------------
+// ExceptionHandler
+// 	Entry point into the Nachos kernel.  Called when a user program
+//	is executing, and either does a syscall, or generates an addressing
+//	or arithmetic exception.
+//
+// 	For system calls, the following is the calling convention:
+//
+// 	system call code -- r2
+//		arg1 -- r4
+//		arg2 -- r5
+//		arg3 -- r6
+//		arg4 -- r7
+//
+//	The result of the system call, if any, must be put back into r2. 
+//
+//	System calls are dispatched through syscallTable; the program
+//	counters are advanced here, before the handler runs.
+//
+//	"which" is the kind of exception.  The list of possible exceptions 
+//	are in machine.h.
+//----------------------------------------------------------------------
+
+void
+ExceptionHandler(ExceptionType which)
+{
+    int type = machine->ReadRegister(2);
+
+    if (which == SyscallException) {
+       if ((type < 0) || (type > MAX_SYSCALL_CODE) || (syscallTable[type] == NULL)) {
+          printf("Unexpected user mode exception %d %d\n", which, type);
+          ASSERT(FALSE);
+       }
+       AdvancePC();
+       if (syscallStats != NULL) MeasuredSyscall(syscallTable[type]);
+       else (*syscallTable[type]->handler)();
+    }
+    else if (which == PageFaultException) {
+       PageFaultHandler();
+    }
+    else if (which == ReadOnlyException) {
+       ReadOnlyHandler();
+    }
+    else {
+       printf("Unexpected user mode exception %d %d\n", which, type);
+       ASSERT(FALSE);
+    }
 }
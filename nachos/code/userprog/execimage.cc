@@ -0,0 +1,213 @@
+// execimage.cc
+//	Routines to load and cache the executable images of user
+//	programs.  See execimage.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "execimage.h"
+
+static ExecImage *imageList = NULL;	// Cached images, most recently used
+					// first
+
+//----------------------------------------------------------------------
+// SwapHeader
+// 	Do little endian to big endian conversion on the bytes in the 
+//	object file header, in case the file was generated on a little
+//	endian machine, and we're now running on a big endian machine.
+//----------------------------------------------------------------------
+
+static void 
+SwapHeader (NoffHeader *noffH)
+{
+	noffH->noffMagic = WordToHost(noffH->noffMagic);
+	noffH->code.size = WordToHost(noffH->code.size);
+	noffH->code.virtualAddr = WordToHost(noffH->code.virtualAddr);
+	noffH->code.inFileAddr = WordToHost(noffH->code.inFileAddr);
+	noffH->initData.size = WordToHost(noffH->initData.size);
+	noffH->initData.virtualAddr = WordToHost(noffH->initData.virtualAddr);
+	noffH->initData.inFileAddr = WordToHost(noffH->initData.inFileAddr);
+	noffH->uninitData.size = WordToHost(noffH->uninitData.size);
+	noffH->uninitData.virtualAddr = WordToHost(noffH->uninitData.virtualAddr);
+	noffH->uninitData.inFileAddr = WordToHost(noffH->uninitData.inFileAddr);
+}
+
+//----------------------------------------------------------------------
+// TrimImageCache
+// 	Delete the least recently used images nobody holds, until at most
+//	MAX_CACHED_IMAGES of them are left.
+//----------------------------------------------------------------------
+
+static void
+TrimImageCache()
+{
+    ExecImage *image, *prev, *victim, *victimPrev;
+    int numUnused;
+
+    for (;;) {
+	numUnused = 0;
+	victim = victimPrev = NULL;
+	for (prev = NULL, image = imageList; image != NULL;
+				prev = image, image = image->next) {
+	    if (image->refCount > 0) continue;
+	    numUnused++;
+	    victim = image;			// the last one is the oldest
+	    victimPrev = prev;
+	}
+	if (numUnused <= MAX_CACHED_IMAGES) return;
+
+	if (victimPrev == NULL) imageList = victim->next;
+	else victimPrev->next = victim->next;
+	DEBUG('a', "Dropping cached image of %s\n", victim->GetName());
+	delete victim;
+    }
+}
+
+//----------------------------------------------------------------------
+// LoadExecImage
+// 	Return the image of the executable "fileName", reading it in if
+//	it is not cached.  The caller holds the image and must Release it.
+//----------------------------------------------------------------------
+
+ExecImage *
+LoadExecImage(char *fileName)
+{
+    ExecImage *image, *prev;
+    OpenFile *executable;
+    NoffHeader noffH;
+
+    for (prev = NULL, image = imageList; image != NULL;
+				prev = image, image = image->next) {
+	if (strcmp(image->GetName(), fileName) != 0) continue;
+	if (prev != NULL) {			// move to the front
+	    prev->next = image->next;
+	    image->next = imageList;
+	    imageList = image;
+	}
+	DEBUG('a', "Using cached image of %s\n", fileName);
+	image->Hold();
+	return image;
+    }
+
+    executable = fileSystem->Open(fileName);
+    if (executable == NULL) return NULL;
+    executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
+    if ((noffH.noffMagic != NOFFMAGIC) && 
+		(WordToHost(noffH.noffMagic) == NOFFMAGIC))
+    	SwapHeader(&noffH);
+    if (noffH.noffMagic != NOFFMAGIC) {
+	printf("%s is not a Nachos executable\n", fileName);
+	delete executable;
+	return NULL;
+    }
+
+    DEBUG('a', "Loading image of %s, code %d bytes, data %d bytes\n",
+	  fileName, noffH.code.size, noffH.initData.size);
+    image = new ExecImage(fileName, &noffH);
+    if (noffH.code.size > 0)
+	executable->ReadAt(image->code, noffH.code.size, noffH.code.inFileAddr);
+    if (noffH.initData.size > 0)
+	executable->ReadAt(image->initData, noffH.initData.size,
+			   noffH.initData.inFileAddr);
+    delete executable;			// everything we need is in memory
+
+    image->next = imageList;
+    imageList = image;
+    image->Hold();
+    return image;
+}
+
+//----------------------------------------------------------------------
+// ExecImage::ExecImage
+// 	Allocate room for the segments described by "header".
+//----------------------------------------------------------------------
+
+ExecImage::ExecImage(char *fileName, NoffHeader *header)
+{
+    name = new char[strlen(fileName) + 1];
+    strcpy(name, fileName);
+    noffH = *header;
+    code = (noffH.code.size > 0) ? new char[noffH.code.size] : NULL;
+    initData = (noffH.initData.size > 0) ? new char[noffH.initData.size] : NULL;
+    refCount = 0;
+    next = NULL;
+}
+
+ExecImage::~ExecImage()
+{
+    ASSERT(refCount == 0);
+    if (code != NULL) delete [] code;
+    if (initData != NULL) delete [] initData;
+    delete [] name;
+}
+
+//----------------------------------------------------------------------
+// ExecImage::GetSize
+// 	Bytes of the address space taken by code and data.
+//----------------------------------------------------------------------
+
+int
+ExecImage::GetSize()
+{
+    return noffH.code.size + noffH.initData.size + noffH.uninitData.size;
+}
+
+//----------------------------------------------------------------------
+// ExecImage::Release
+// 	An address space no longer uses the image.  It stays cached, but
+//	may push an older unused image out.
+//----------------------------------------------------------------------
+
+void
+ExecImage::Release()
+{
+    ASSERT(refCount > 0);
+    refCount--;
+    if (refCount == 0) TrimImageCache();
+}
+
+//----------------------------------------------------------------------
+// CopySegment
+//	Copy the bytes of segment "seg", held in "contents", that fall in
+//	[pageStart, pageEnd) to the same offsets of "into".  Returns FALSE
+//	if the segment does not overlap the page.
+//----------------------------------------------------------------------
+
+static bool
+CopySegment(Segment *seg, char *contents, char *into, unsigned pageStart,
+	    unsigned pageEnd)
+{
+    unsigned overlapStart, overlapEnd;
+    unsigned segStart = seg->virtualAddr;
+    unsigned segEnd = seg->virtualAddr + seg->size;	// one past the end
+
+    if (seg->size <= 0) return FALSE;
+    overlapStart = (segStart > pageStart) ? segStart : pageStart;
+    overlapEnd = (segEnd < pageEnd) ? segEnd : pageEnd;
+    if (overlapStart >= overlapEnd) return FALSE;	// not in this page
+
+    bcopy(&contents[overlapStart - segStart], &into[overlapStart - pageStart],
+	  overlapEnd - overlapStart);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// ExecImage::CopyPage
+// 	Fill in the parts of page "vpn" that hold code or initialized
+//	data.  The caller has zeroed the page already.
+//----------------------------------------------------------------------
+
+bool
+ExecImage::CopyPage(char *into, unsigned vpn)
+{
+    unsigned pageStart = vpn * PageSize;
+    unsigned pageEnd = pageStart + PageSize;	// one past the end
+    bool codeRead, dataRead;
+
+    codeRead = CopySegment(&noffH.code, code, into, pageStart, pageEnd);
+    dataRead = CopySegment(&noffH.initData, initData, into, pageStart, pageEnd);
+    return (codeRead || dataRead);
+}
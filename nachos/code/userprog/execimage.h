@@ -0,0 +1,56 @@
+// execimage.h
+//	Data structures for the executable images of user programs.
+//
+//	The code and initialized data of an executable are read into
+//	kernel memory once, when the first process runs it, and pages of
+//	every address space running the program are filled from that
+//	copy.  A batch of identical jobs, or a shell starting the same
+//	command again and again, reads the file only once.
+//
+//	Images are reference counted by the address spaces using them.
+//	Up to MAX_CACHED_IMAGES images nobody uses are kept around in case
+//	the program is started again; the least recently used goes first.
+//	A cached image is assumed not to change on disk.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef EXECIMAGE_H
+#define EXECIMAGE_H
+
+#include "copyright.h"
+#include "noff.h"
+
+#define MAX_CACHED_IMAGES	8	// Unused images kept in the cache
+
+class ExecImage {
+  public:
+    ExecImage(char *fileName, NoffHeader *header);	// Empty segments
+    ~ExecImage();
+
+    char *GetName() { return name; }
+    int GetSize();			// Code, data and bss, in bytes
+    bool CopyPage(char *into, unsigned vpn);	// Copy the code and data in
+					// page "vpn"; FALSE if there are none.
+					// The rest of "into" is left alone.
+
+    void Hold() { refCount++; }		// One more address space uses it
+    void Release();			// One fewer
+
+    char *code;				// Contents of the code segment
+    char *initData;			// Contents of the initialized data
+    NoffHeader noffH;
+
+    int refCount;			// Address spaces using the image
+    ExecImage *next;			// Cache list, most recently used first
+
+  private:
+    char *name;
+};
+
+extern ExecImage *LoadExecImage(char *fileName);	// Held image of
+					// "fileName", or NULL if it cannot
+					// be opened or is not a NOFF file
+
+#endif // EXECIMAGE_H
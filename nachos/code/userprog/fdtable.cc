@@ -0,0 +1,185 @@
+// fdtable.cc
+//	Routines to manage the open files of a user process.  See
+//	fdtable.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "fdtable.h"
+#include "pipe.h"
+#include "syscall.h"
+
+//----------------------------------------------------------------------
+// SharedFile::~SharedFile
+// 	Close the file, or this end of the pipe, once no id refers to it
+//	any more.  The pipe goes away with the last of its two ends.
+//----------------------------------------------------------------------
+
+SharedFile::~SharedFile()
+{
+    if (pipe == NULL) delete file;
+    else if (pipe->CloseEnd(writeEnd)) delete pipe;
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::OpenFileTable
+// 	Create the table of a new process: nothing is open besides the
+//	console.
+//----------------------------------------------------------------------
+
+OpenFileTable::OpenFileTable()
+{
+    int i;
+
+    for (i = 0; i < MAX_OPEN_FILES; i++) files[i] = NULL;
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::OpenFileTable(OpenFileTable *, int)
+// 	Create the table of a child process.  The child's ids below
+//	"numIds" refer to the same open files as the parent's; the
+//	others are free.  A forked child gets all of them
+//	(MAX_OPEN_FILES), a spawned one only the console ids
+//	(FIRST_FILE_ID).
+//----------------------------------------------------------------------
+
+OpenFileTable::OpenFileTable(OpenFileTable *parentTable, int numIds)
+{
+    int i;
+
+    for (i = 0; i < MAX_OPEN_FILES; i++) {
+	files[i] = (i < numIds) ? parentTable->files[i] : NULL;
+	if (files[i] != NULL) files[i]->refCount++;
+    }
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::~OpenFileTable
+// 	Close every id still open; called when the process exits.
+//----------------------------------------------------------------------
+
+OpenFileTable::~OpenFileTable()
+{
+    int i;
+
+    for (i = 0; i < MAX_OPEN_FILES; i++)
+	if (files[i] != NULL) Close(i);
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::Add
+// 	Give "file" the lowest free id.
+//----------------------------------------------------------------------
+
+int
+OpenFileTable::Add(OpenFile *file)
+{
+    int i;
+
+    for (i = FIRST_FILE_ID; i < MAX_OPEN_FILES; i++) {
+	if (files[i] == NULL) {
+	    files[i] = new SharedFile(file);
+	    return i;
+	}
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::AddPipe
+// 	Give the two ends of "pipe" the lowest two free ids.  Returns
+//	FALSE, with nothing added, if there are not two free ids.
+//----------------------------------------------------------------------
+
+bool
+OpenFileTable::AddPipe(Pipe *pipe, int *readId, int *writeId)
+{
+    int i, found = 0, ids[2];
+
+    for (i = FIRST_FILE_ID; (i < MAX_OPEN_FILES) && (found < 2); i++)
+	if (files[i] == NULL) ids[found++] = i;
+    if (found < 2) return FALSE;
+    files[ids[0]] = new SharedFile(pipe, FALSE);
+    files[ids[1]] = new SharedFile(pipe, TRUE);
+    *readId = ids[0];
+    *writeId = ids[1];
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::Get
+// 	Return the open file behind "id"; NULL for a pipe end, or if
+//	nothing is open there.
+//----------------------------------------------------------------------
+
+OpenFile *
+OpenFileTable::Get(int id)
+{
+    SharedFile *entry = Lookup(id);
+
+    return (entry != NULL) ? entry->file : NULL;
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::Lookup
+// 	Return whatever is open at "id", file or pipe end.  Ids 0 and 1
+//	only have an entry while they are redirected.
+//----------------------------------------------------------------------
+
+SharedFile *
+OpenFileTable::Lookup(int id)
+{
+    if ((id < 0) || (id >= MAX_OPEN_FILES)) return NULL;
+    return files[id];
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::IsConsole
+// 	TRUE if "id" is ConsoleInput or ConsoleOutput and still refers
+//	to the console.
+//----------------------------------------------------------------------
+
+bool
+OpenFileTable::IsConsole(int id)
+{
+    return ((id == ConsoleInput) || (id == ConsoleOutput)) && (files[id] == NULL);
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::Dup2
+// 	Make "newId" refer to the file or pipe end open at "oldId",
+//	closing whatever "newId" referred to first.  This is how the
+//	console ids are redirected.
+//----------------------------------------------------------------------
+
+int
+OpenFileTable::Dup2(int oldId, int newId)
+{
+    SharedFile *entry = Lookup(oldId);
+
+    if ((entry == NULL) || (newId < 0) || (newId >= MAX_OPEN_FILES)) return -1;
+    if (oldId == newId) return newId;
+    entry->refCount++;			// first, in case "newId" already
+    Close(newId);			// refers to the same entry
+    files[newId] = entry;
+    return newId;
+}
+
+//----------------------------------------------------------------------
+// OpenFileTable::Close
+// 	Free "id".  The file itself is closed once no id of any process
+//	refers to it.  Closing a redirected console id makes it refer
+//	to the console again.
+//----------------------------------------------------------------------
+
+bool
+OpenFileTable::Close(int id)
+{
+    if (Lookup(id) == NULL) return FALSE;
+    files[id]->Release();
+    files[id] = NULL;
+    return TRUE;
+}
@@ -0,0 +1,71 @@
+// fdtable.h
+//	Data structures for the open files of a user process.
+//
+//	Every process has a table mapping small integers (OpenFileId) to
+//	open files and pipe ends.  Ids 0 and 1 are the console
+//	(ConsoleInput and ConsoleOutput) unless Dup2 puts something else
+//	there; closing them again goes back to the console.  The table
+//	hands out new ids from FIRST_FILE_ID up.
+//
+//	A forked child gets a copy of its parent's table.  Both tables
+//	then point at the same open file, and so share its position, as
+//	in UNIX; the file is closed when the last id referring to it is.
+//	A spawned child only gets ids 0 and 1: it cannot know about any
+//	other id, and would only keep pipe ends open that others wait on.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef FDTABLE_H
+#define FDTABLE_H
+
+#include "copyright.h"
+#include "filesys.h"
+
+class Pipe;
+
+#define MAX_OPEN_FILES		16	// Ids per process, console included
+#define FIRST_FILE_ID		2	// 0 and 1 are the console
+
+// An OpenFile, or one end of a pipe, together with the number of ids
+// that refer to it.
+
+class SharedFile {
+  public:
+    SharedFile(OpenFile *f) { file = f; pipe = NULL; writeEnd = FALSE; refCount = 1; }
+    SharedFile(Pipe *p, bool w) { file = NULL; pipe = p; writeEnd = w; refCount = 1; }
+    ~SharedFile();			// closes the file or the pipe end
+
+    void Hold() { refCount++; }		// Keep it open while the kernel
+    void Release() { if (--refCount == 0) delete this; }	// uses it
+
+    OpenFile *file;			// NULL for a pipe end
+    Pipe *pipe;
+    bool writeEnd;			// Which end of "pipe"
+    int refCount;
+};
+
+class OpenFileTable {
+  public:
+    OpenFileTable();			// Only the console is open
+    OpenFileTable(OpenFileTable *parentTable, int numIds);
+					// Share the parent's ids below
+					// "numIds" (fork, spawn)
+    ~OpenFileTable();			// Close everything
+
+    int Add(OpenFile *file);		// Return the new id, or -1 if the
+					// table is full
+    bool AddPipe(Pipe *pipe, int *readId, int *writeId);	// Both ends
+    OpenFile *Get(int id);		// NULL if "id" is not an open file
+    SharedFile *Lookup(int id);		// NULL if nothing is open at "id"
+    bool IsConsole(int id);		// "id" is 0 or 1, not redirected
+    int Dup2(int oldId, int newId);	// Make "newId" refer to what "oldId"
+					// does; returns newId, or -1
+    bool Close(int id);			// FALSE if nothing is open at "id"
+
+  private:
+    SharedFile *files[MAX_OPEN_FILES];	// NULL for free ids
+};
+
+#endif // FDTABLE_H
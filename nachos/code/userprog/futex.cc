@@ -0,0 +1,113 @@
+// futex.cc
+//	Routines to sleep on and wake up words of user memory.
+//
+//	Each bucket of the hash table is a FIFO list of waiters.  A
+//	waiter lives on the kernel stack of the sleeping thread, and is
+//	unlinked by the thread that wakes it.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "futex.h"
+
+struct FutexWaiter {
+   Thread *thread;
+   int paddr;				// Physical address of the word
+   FutexWaiter *next;
+};
+
+static FutexWaiter *bucketHead[NUM_FUTEX_BUCKETS];	// all NULL at start
+static FutexWaiter *bucketTail[NUM_FUTEX_BUCKETS];
+
+#define FutexBucket(paddr)	(((unsigned)(paddr) >> 2) % NUM_FUTEX_BUCKETS)
+
+//----------------------------------------------------------------------
+// FutexAddress
+// 	Physical address of the user word at "vaddr", paging it in if
+//	needed.  Returns -1 for an unaligned or bad address.  Called with
+//	interrupts off; they stay off, so the page stays resident until
+//	the caller is done.
+//----------------------------------------------------------------------
+
+static int
+FutexAddress(int vaddr)
+{
+   int paddr;
+
+   if ((vaddr & 3) != 0) return -1;
+   if (machine->TranslateForCopy(vaddr, &paddr, FALSE) != NoException) return -1;
+   return paddr;
+}
+
+//----------------------------------------------------------------------
+// FutexWait
+// 	Put the current thread to sleep on the word at "vaddr", unless it
+//	no longer holds "expected".
+//----------------------------------------------------------------------
+
+int
+FutexWait(int vaddr, int expected)
+{
+   IntStatus oldLevel = interrupt->SetLevel(IntOff);
+   int paddr = FutexAddress(vaddr);
+   FutexWaiter self;
+   int b;
+
+   if ((paddr < 0) ||
+       ((int)WordToHost(*(unsigned *)&machine->mainMemory[paddr]) != expected)) {
+      (void) interrupt->SetLevel(oldLevel);
+      return -1;
+   }
+
+   self.thread = currentThread;
+   self.paddr = paddr;
+   self.next = NULL;
+   b = FutexBucket(paddr);
+   if (bucketHead[b] == NULL) bucketHead[b] = &self;
+   else bucketTail[b]->next = &self;
+   bucketTail[b] = &self;
+
+   DEBUG('a', "Futex wait on 0x%x (frame %d)\n", vaddr, paddr / PageSize);
+   currentThread->Sleep();		// FutexWake takes us off the list
+   (void) interrupt->SetLevel(oldLevel);
+   return 0;
+}
+
+//----------------------------------------------------------------------
+// FutexWake
+// 	Wake up at most "count" of the threads sleeping on the word at
+//	"vaddr", in the order they went to sleep.
+//----------------------------------------------------------------------
+
+int
+FutexWake(int vaddr, int count)
+{
+   IntStatus oldLevel = interrupt->SetLevel(IntOff);
+   int paddr = FutexAddress(vaddr);
+   FutexWaiter *waiter, *prev = NULL, *next;
+   int b, woken = 0;
+
+   if (paddr < 0) {
+      (void) interrupt->SetLevel(oldLevel);
+      return -1;
+   }
+
+   b = FutexBucket(paddr);
+   for (waiter = bucketHead[b]; (waiter != NULL) && (woken < count); waiter = next) {
+      next = waiter->next;
+      if (waiter->paddr != paddr) {
+         prev = waiter;
+         continue;
+      }
+      if (prev == NULL) bucketHead[b] = next;
+      else prev->next = next;
+      if (bucketTail[b] == waiter) bucketTail[b] = prev;
+      scheduler->ReadyToRun(waiter->thread);
+      woken++;
+   }
+   (void) interrupt->SetLevel(oldLevel);
+   return woken;
+}
@@ -0,0 +1,40 @@
+// futex.h
+//	Routines for fast user-level synchronization.
+//
+//	A futex is an aligned word of user memory, normally in a shared
+//	memory page.  User code does all the work on the word itself
+//	with atomic operations, and only asks the kernel to
+//
+//	   FutexWait -- sleep, provided the word still holds the value
+//		the caller last saw (checked with interrupts off, so a
+//		FutexWake in between cannot be missed);
+//	   FutexWake -- wake some of the threads sleeping on the word.
+//
+//	Waiters are kept in a hash table keyed by the physical address of
+//	the word, so processes that map the same shared page at different
+//	virtual addresses meet in the same queue.  Shared pages are never
+//	replaced, so their physical address is stable.
+//
+//	The atomic operations themselves are restartable sequences: a
+//	program tells the kernel where its sequence is (SetAtomicRegion),
+//	and a thread switched out in the middle of it is sent back to its
+//	start (see AddrSpace::RestartAtomicRegion).
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include "copyright.h"
+
+#define NUM_FUTEX_BUCKETS	64	// Wait queues in the hash table
+
+extern int FutexWait(int vaddr, int expected);	// 0 once woken, -1 if the word
+						// did not hold "expected" or
+						// "vaddr" is bad
+extern int FutexWake(int vaddr, int count);	// Number of threads woken, -1
+						// if "vaddr" is bad
+
+#endif // FUTEX_H
@@ -0,0 +1,177 @@
+// ipctable.cc
+//	Routines to register IPC objects by key and id.  See ipctable.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "ipctable.h"
+
+//----------------------------------------------------------------------
+// IpcTable::IpcTable
+// 	Create an empty registry.
+//----------------------------------------------------------------------
+
+IpcTable::IpcTable()
+{
+    int i;
+
+    numSlots = IPC_INITIAL_SLOTS;
+    slots = new IpcSlot[numSlots];
+    bucketHead = new int[numSlots];
+    for (i = 0; i < numSlots; i++) {
+	slots[i].object = NULL;
+	slots[i].generation = 0;
+	slots[i].next = (i + 1 < numSlots) ? i + 1 : -1;
+	bucketHead[i] = -1;
+    }
+    freeList = 0;
+    numObjects = 0;
+}
+
+IpcTable::~IpcTable()
+{
+    delete [] slots;
+    delete [] bucketHead;
+}
+
+//----------------------------------------------------------------------
+// IpcTable::SlotOf
+// 	Slot named by "id", or -1 if the id is out of range, the slot is
+//	free, or the slot has been reused since the id was handed out.
+//----------------------------------------------------------------------
+
+int
+IpcTable::SlotOf(int id)
+{
+    int index = id & (IPC_MAX_OBJECTS - 1);
+
+    if ((id < 0) || (index >= numSlots)) return -1;
+    if ((slots[index].object == NULL) ||
+	(slots[index].generation != (id >> IPC_INDEX_BITS)))
+	return -1;
+    return index;
+}
+
+//----------------------------------------------------------------------
+// IpcTable::Find
+// 	Walk the hash chain of "key".
+//----------------------------------------------------------------------
+
+int
+IpcTable::Find(int key)
+{
+    int i;
+
+    for (i = bucketHead[Bucket(key)]; i != -1; i = slots[i].next)
+	if (slots[i].key == key)
+	    return (slots[i].generation << IPC_INDEX_BITS) | i;
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// IpcTable::Add
+// 	Put "object" in a free slot, growing the table if there is none,
+//	and chain it on the bucket of "key".  The key must not be in the
+//	table already.
+//----------------------------------------------------------------------
+
+int
+IpcTable::Add(int key, void *object)
+{
+    int i, b;
+
+    ASSERT((object != NULL) && (Find(key) == -1));
+    if (freeList == -1) {
+	if (numSlots == IPC_MAX_OBJECTS) return -1;
+	Grow();
+    }
+    i = freeList;
+    freeList = slots[i].next;
+
+    b = Bucket(key);
+    slots[i].object = object;
+    slots[i].key = key;
+    slots[i].next = bucketHead[b];
+    bucketHead[b] = i;
+    numObjects++;
+    return (slots[i].generation << IPC_INDEX_BITS) | i;
+}
+
+//----------------------------------------------------------------------
+// IpcTable::Lookup
+//----------------------------------------------------------------------
+
+void *
+IpcTable::Lookup(int id)
+{
+    int i = SlotOf(id);
+
+    return (i == -1) ? NULL : slots[i].object;
+}
+
+//----------------------------------------------------------------------
+// IpcTable::Remove
+// 	Unchain the slot of "id" from its bucket and free it.  Its
+//	generation moves on, so "id" is stale from now on.
+//----------------------------------------------------------------------
+
+void *
+IpcTable::Remove(int id)
+{
+    int i = SlotOf(id);
+    int *link;
+    void *object;
+
+    if (i == -1) return NULL;
+    for (link = &bucketHead[Bucket(slots[i].key)]; *link != i;
+	 link = &slots[*link].next)
+	ASSERT(*link != -1);
+    *link = slots[i].next;
+
+    object = slots[i].object;
+    slots[i].object = NULL;
+    slots[i].generation = (slots[i].generation + 1) & IPC_GENERATION_MASK;
+    slots[i].next = freeList;
+    freeList = i;
+    numObjects--;
+    return object;
+}
+
+//----------------------------------------------------------------------
+// IpcTable::Grow
+// 	Double the number of slots.  Slots keep their index (so ids stay
+//	valid); the hash chains are rebuilt for the new bucket count, and
+//	the new slots become the free list.  Only called when no slot is
+//	free.
+//----------------------------------------------------------------------
+
+void
+IpcTable::Grow()
+{
+    int oldSlots = numSlots, i, b;
+    IpcSlot *newSlots;
+
+    ASSERT(freeList == -1);
+    numSlots *= 2;
+    newSlots = new IpcSlot[numSlots];
+    delete [] bucketHead;
+    bucketHead = new int[numSlots];
+    for (i = 0; i < numSlots; i++) bucketHead[i] = -1;
+
+    for (i = 0; i < oldSlots; i++) {
+	newSlots[i] = slots[i];
+	b = Bucket(newSlots[i].key);
+	newSlots[i].next = bucketHead[b];
+	bucketHead[b] = i;
+    }
+    for (; i < numSlots; i++) {
+	newSlots[i].object = NULL;
+	newSlots[i].generation = 0;
+	newSlots[i].next = (i + 1 < numSlots) ? i + 1 : -1;
+    }
+    freeList = oldSlots;
+    delete [] slots;
+    slots = newSlots;
+}
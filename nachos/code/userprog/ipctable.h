@@ -0,0 +1,65 @@
+// ipctable.h
+//	Data structures for the registries of System V style IPC objects
+//	(semaphores, condition variables): user programs find an object
+//	by a key of their choosing, and then name it by the id the
+//	registry hands out.
+//
+//	Objects live in a table of slots that doubles when it fills up.
+//	An id is the slot index together with the generation of the
+//	slot, which is bumped every time an object is removed from it;
+//	an id kept after its object was removed is therefore rejected
+//	instead of naming whatever object took the slot next.  Keys are
+//	found through a hash table chained through the slots.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef IPCTABLE_H
+#define IPCTABLE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+#define IPC_INDEX_BITS		16	// Low bits of an id: the slot
+#define IPC_MAX_OBJECTS		(1 << IPC_INDEX_BITS)
+#define IPC_GENERATION_MASK	0x7fff	// High bits: the generation (ids
+					// stay positive)
+#define IPC_INITIAL_SLOTS	16
+
+struct IpcSlot {
+    void *object;			// NULL if the slot is free
+    int key;
+    int generation;
+    int next;				// Next slot on the same hash chain, or
+					// on the free list; -1 at the end
+};
+
+class IpcTable {
+  public:
+    IpcTable();
+    ~IpcTable();			// The objects are not deleted
+
+    int Find(int key);			// Id of the object with "key", -1 if
+					// there is none
+    int Add(int key, void *object);	// Register "object"; return its id,
+					// or -1 if the table is full
+    void *Lookup(int id);		// The object, NULL for a bad or stale id
+    void *Remove(int id);		// Unregister; returns the object, NULL
+					// for a bad or stale id
+
+    int NumObjects() { return numObjects; }
+
+  private:
+    int Bucket(int key) { return (unsigned)key % numSlots; }
+    int SlotOf(int id);			// -1 unless "id" is current
+    void Grow();			// Double the slots, rehash
+
+    IpcSlot *slots;
+    int *bucketHead;			// numSlots buckets
+    int numSlots;
+    int numObjects;
+    int freeList;			// First free slot, -1 if none
+};
+
+#endif // IPCTABLE_H
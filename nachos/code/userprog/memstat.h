@@ -0,0 +1,31 @@
+/* memstat.h
+ *	Indices of the per-process memory counters: kept by AddrSpace,
+ *	returned to user programs by sys_MemStat, and printed at halt.
+ *
+ *	This file is included by user programs and by the Nachos kernel.
+ *
+ * Copyright (c) 1992-1993 The Regents of the University of California.
+ * All rights reserved.  See copyright.h for copyright notice and limitation
+ * of liability and disclaimer of warranty provisions.
+ */
+
+#ifndef MEMSTAT_H
+#define MEMSTAT_H
+
+#include "copyright.h"
+
+// Per-process memory counters returned by sys_MemStat, one int each
+#define MEMSTAT_RESIDENT	0	// Private pages in physical memory
+#define MEMSTAT_PEAK_RESIDENT	1	// Most private pages ever resident
+#define MEMSTAT_SHARED		2	// Shared memory pages
+#define MEMSTAT_SWAPPED		3	// Pages in the compressed pool or backing store
+#define MEMSTAT_MAJOR_FAULTS	4	// Faults that read the backing store or
+					// the executable
+#define MEMSTAT_MINOR_FAULTS	5	// Zero-fill, compressed pool and
+					// copy-on-write faults
+#define MEMSTAT_EVICTIONS	6	// Pages taken away by page replacement
+#define MEMSTAT_LIMIT		7	// Resident-set limit, 0 if none
+
+#define NUM_MEM_STATS		8
+
+#endif
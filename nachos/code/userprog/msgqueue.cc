@@ -0,0 +1,206 @@
+// msgqueue.cc
+//	Routines for kernel message queues.
+//
+//	Messages are built before the queue lock is taken and delivered
+//	after it is released, since copying from or to user memory can
+//	fault and sleep.  The lock only covers the list itself.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "msgqueue.h"
+#include "pagemerge.h"
+
+// One queued message.  Exactly one of "data" and "frames" is set.
+class Message {
+  public:
+    int size;				// In bytes
+    char *data;				// Copied contents
+    int *frames;			// Lent frames, size / PageSize of them
+};
+
+//----------------------------------------------------------------------
+// DropLentFrame
+// 	Give back the reference a message holds on a lent frame.  The
+//	frame is freed if no page table maps it any more.
+//----------------------------------------------------------------------
+
+static void
+DropLentFrame(int frame)
+{
+    TranslationEntry entry;		// stands for the message's mapping
+
+    entry.physicalPage = frame;
+    entry.readOnly = TRUE;
+    entry.cow = TRUE;
+    ReleaseUserFrame(&entry);
+}
+
+//----------------------------------------------------------------------
+// DeleteMessage
+// 	Free a message, and any frames it still holds.
+//----------------------------------------------------------------------
+
+static void
+DeleteMessage(Message *msg)
+{
+    int i;
+
+    if (msg->frames != NULL) {
+	for (i = 0; i < msg->size / PageSize; i++) DropLentFrame(msg->frames[i]);
+	delete [] msg->frames;
+    }
+    if (msg->data != NULL) delete [] msg->data;
+    delete msg;
+}
+
+//----------------------------------------------------------------------
+// LendPages
+// 	Try to build "msg" out of the frames of the current address
+//	space.  Returns FALSE, with nothing lent, if some page of the
+//	buffer cannot be lent.
+//----------------------------------------------------------------------
+
+static bool
+LendPages(Message *msg, int vaddr)
+{
+    int numPages = msg->size / PageSize;
+    int i, frame;
+
+    msg->frames = new int[numPages];
+    for (i = 0; i < numPages; i++) {
+	frame = currentThread->space->LendFrame(vaddr / PageSize + i);
+	if (frame == -1) {
+	    while (--i >= 0) DropLentFrame(msg->frames[i]);
+	    delete [] msg->frames;
+	    msg->frames = NULL;
+	    return FALSE;
+	}
+	msg->frames[i] = frame;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// MessageQueue::MessageQueue
+// 	Initialize an empty queue for up to "size" messages.
+//----------------------------------------------------------------------
+
+MessageQueue::MessageQueue(int size)
+{
+    lock = new Lock("message queue lock");
+    notFull = new Condition("message queue not full");
+    notEmpty = new Condition("message queue not empty");
+    messages = new List;
+    numMessages = 0;
+    capacity = size;
+    numWaiting = 0;
+}
+
+//----------------------------------------------------------------------
+// MessageQueue::~MessageQueue
+// 	Throw away the messages nobody received.
+//----------------------------------------------------------------------
+
+MessageQueue::~MessageQueue()
+{
+    Message *msg;
+
+    ASSERT(numWaiting == 0);
+    while ((msg = (Message *)messages->Remove()) != NULL) DeleteMessage(msg);
+    delete messages;
+    delete notEmpty;
+    delete notFull;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// MessageQueue::Send
+// 	Make a message of the "size" bytes at "vaddr" in the current
+//	address space, then wait until the queue has room for it.
+//	Whole page-aligned pages are lent rather than copied.  Returns
+//	FALSE if the buffer is not in the address space.
+//----------------------------------------------------------------------
+
+bool
+MessageQueue::Send(int vaddr, int size)
+{
+    Message *msg = new Message;
+
+    msg->size = size;
+    msg->data = NULL;
+    msg->frames = NULL;
+    if ((size == 0) || ((vaddr % PageSize) != 0) || ((size % PageSize) != 0) ||
+	!LendPages(msg, vaddr)) {
+	msg->data = new char[size];
+	if (!machine->CopyFromUser(vaddr, msg->data, size)) {
+	    DeleteMessage(msg);
+	    return FALSE;
+	}
+    }
+
+    lock->Acquire();
+    numWaiting++;
+    while (numMessages == capacity) notFull->Wait(lock);
+    numWaiting--;
+    messages->Append((void *)msg);
+    numMessages++;
+    notEmpty->Signal(lock);
+    lock->Release();
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// MessageQueue::Receive
+// 	Wait for a message and store it at "vaddr" in the current address
+//	space, which has room for "size" bytes.  Lent frames are mapped
+//	into the buffer where it is page-aligned, and copied otherwise.
+//	Returns the size of the message, or -1.
+//----------------------------------------------------------------------
+
+int
+MessageQueue::Receive(int vaddr, int size)
+{
+    Message *msg;
+    bool stored = TRUE;
+    int i, frame, result;
+
+    lock->Acquire();
+    numWaiting++;
+    while (numMessages == 0) notEmpty->Wait(lock);
+    numWaiting--;
+    msg = (Message *)messages->Remove();
+    if (msg->size > size) {		// leave it for a bigger buffer
+	messages->Prepend((void *)msg);
+	lock->Release();
+	return -1;
+    }
+    numMessages--;
+    notFull->Signal(lock);
+    lock->Release();
+
+    if (msg->frames != NULL) {
+	for (i = 0; i < msg->size / PageSize; i++) {
+	    frame = msg->frames[i];
+	    if (((vaddr % PageSize) == 0) &&
+		currentThread->space->MapLentFrame(vaddr / PageSize + i, frame)) {
+		stats->numPagesRemapped++;
+		continue;
+	    }
+	    if (!machine->CopyToUser(vaddr + i * PageSize,
+				     &machine->mainMemory[frame * PageSize], PageSize))
+		stored = FALSE;
+	    DropLentFrame(frame);
+	}
+	delete [] msg->frames;
+	msg->frames = NULL;
+    }
+    else stored = machine->CopyToUser(vaddr, msg->data, msg->size);
+
+    result = stored ? msg->size : -1;
+    DeleteMessage(msg);
+    return result;
+}
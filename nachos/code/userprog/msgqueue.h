@@ -0,0 +1,57 @@
+// msgqueue.h
+//	Data structures for the kernel message queues behind MsgSend and
+//	MsgReceive.
+//
+//	A queue holds at most "capacity" messages.  Senders wait while it
+//	is full and receivers wait while it is empty.  A message is kept
+//	in one of two forms:
+//
+//	   copied -- the bytes, brought in with CopyFromUser and handed
+//		out with CopyToUser.
+//	   lent frames -- when the sender's buffer is made of whole,
+//		page-aligned, resident private pages, the frames
+//		themselves (see AddrSpace::LendFrame).  They stay mapped
+//		copy-on-write in the sender and are mapped copy-on-write
+//		into a page-aligned receiving buffer, so the data is only
+//		copied if one side writes to it.
+//
+//	A receiving buffer that is not page-aligned, or a page of it that
+//	cannot be remapped (shared memory), gets a plain copy of the frame.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef MSGQUEUE_H
+#define MSGQUEUE_H
+
+#include "copyright.h"
+#include "list.h"
+#include "synch.h"
+
+class MessageQueue {
+  public:
+    MessageQueue(int capacity);		// Room for "capacity" messages
+    ~MessageQueue();			// Drops queued messages; assumes
+					// nobody is waiting
+
+    int GetCapacity() { return capacity; }
+    bool IsBusy() { return (numWaiting > 0); }	// Somebody is blocked
+
+    bool Send(int vaddr, int size);	// Queue "size" bytes of the current
+					// address space, waiting for room
+    int Receive(int vaddr, int size);	// Wait for a message and deliver it
+					// at "vaddr"; its size, or -1 if
+					// it is larger than "size" (it then
+					// stays queued) or cannot be stored
+
+  private:
+    Lock *lock;				// Protects everything below
+    Condition *notFull, *notEmpty;
+    List *messages;			// Oldest first
+    int numMessages;
+    int capacity;
+    int numWaiting;			// Threads blocked in Send or Receive
+};
+
+#endif // MSGQUEUE_H
@@ -0,0 +1,229 @@
+// pagemerge.cc
+//	Routines to merge byte-identical physical frames of user programs.
+//
+//	Identical batch jobs and forked children end up with many private
+//	pages holding the same bytes (zeroed bss, copied stacks, data
+//	duplicated by AddrSpace(AddrSpace*)).  A kernel thread scans the
+//	page tables of all live threads, keeps a hash table of frame
+//	contents, and whenever two frames compare equal it remaps the
+//	second page onto the first frame and frees the duplicate.
+//
+//	A merged frame is mapped read-only by everybody; frameCowCount
+//	records how many copy-on-write mappings it has.  Private frames
+//	have a count of zero.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "pagemerge.h"
+
+// The hash table is rebuilt from scratch on every scan.  Buckets are
+// chained through the frame numbers themselves.  The per-frame arrays
+// are allocated by the first scan, once NumPhysPages is known.
+static int bucketHead[MERGE_HASH_BUCKETS];
+static int *bucketNext = NULL;
+static unsigned *frameHash;
+static bool *frameInTable;
+static TranslationEntry **frameOwner;	// first mapping found
+
+//----------------------------------------------------------------------
+// HashFrame
+// 	FNV-1a hash of the contents of a physical frame.
+//----------------------------------------------------------------------
+
+static unsigned
+HashFrame(int frame)
+{
+   unsigned h = 2166136261u;
+   char *p = &machine->mainMemory[frame * PageSize];
+   int i;
+
+   for (i = 0; i < PageSize; i++) {
+      h ^= (unsigned char)p[i];
+      h *= 16777619u;
+   }
+   return h;
+}
+
+//----------------------------------------------------------------------
+// ReleaseUserFrame
+// 	Drop the mapping "entry" has on its frame.  A merged frame is
+//	only freed once its last copy-on-write mapping goes away.
+//----------------------------------------------------------------------
+
+void
+ReleaseUserFrame(TranslationEntry *entry)
+{
+   int frame = entry->physicalPage;
+
+   if (entry->cow) {
+      ASSERT(frameCowCount[frame] > 0);
+      frameCowCount[frame]--;
+      entry->cow = FALSE;
+      entry->readOnly = FALSE;
+      if (frameCowCount[frame] > 0) return;	// still mapped by others
+   }
+   PhyPageIsAllocated[frame] = FALSE;
+   frameSpace[frame] = NULL;
+   numPagesAllocated--;
+}
+
+//----------------------------------------------------------------------
+// BreakCopyOnWrite
+// 	Called by the ReadOnlyException handler when a user program
+//	writes to a merged page.  Give the page a private, writable copy
+//	of the frame.  If this is the only mapping left, the frame is
+//	simply handed back to it.  "entry" belongs to currentThread.
+//----------------------------------------------------------------------
+
+void
+BreakCopyOnWrite(TranslationEntry *entry)
+{
+   int oldFrame = entry->physicalPage;
+   int newFrame;
+
+   ASSERT(entry->cow && (frameCowCount[oldFrame] > 0));
+   stats->numCowFaults++;
+
+   if (frameCowCount[oldFrame] > 1) {
+      newFrame = FindFreeFrame();
+      bcopy(&machine->mainMemory[oldFrame * PageSize],
+            &machine->mainMemory[newFrame * PageSize], PageSize);
+      frameCowCount[oldFrame]--;
+      entry->physicalPage = newFrame;
+   }
+   else {
+      frameCowCount[oldFrame] = 0;
+   }
+   frameSpace[entry->physicalPage] = currentThread->space;	// replaceable again
+   frameVpn[entry->physicalPage] = entry->virtualPage;
+   entry->cow = FALSE;
+   entry->readOnly = FALSE;
+   DEBUG('a', "Copy-on-write break of vpn %d, frame %d -> %d\n",
+         entry->virtualPage, oldFrame, entry->physicalPage);
+}
+
+//----------------------------------------------------------------------
+// MergeIdenticalFrames
+// 	Scan every valid private page of every live thread.  The first
+//	frame seen with given contents goes into the hash table; any
+//	later frame with the same contents is released and its page is
+//	remapped read-only onto the frame in the table.
+//
+//	Shared memory pages are left alone, and so are pages that are
+//	read-only for a reason other than merging.
+//----------------------------------------------------------------------
+
+void
+MergeIdenticalFrames()
+{
+   IntStatus oldLevel = interrupt->SetLevel(IntOff);
+   TranslationEntry *pageTable, *entry;
+   unsigned vpn, numPages, h;
+   int pid, frame, other, b;
+   Thread *thread;
+
+   if (bucketNext == NULL) {
+      bucketNext = new int[NumPhysPages];
+      frameHash = new unsigned[NumPhysPages];
+      frameInTable = new bool[NumPhysPages];
+      frameOwner = new TranslationEntry*[NumPhysPages];
+   }
+   for (b = 0; b < MERGE_HASH_BUCKETS; b++) bucketHead[b] = -1;
+   for (frame = 0; frame < NumPhysPages; frame++) frameInTable[frame] = FALSE;
+
+   for (pid = 0; pid < processTable->NumSlots(); pid++) {
+      thread = processTable->Lookup(pid);
+      if ((thread == NULL) || (thread->space == NULL)) continue;
+
+      pageTable = thread->space->GetPageTable();
+      numPages = thread->space->GetNumPages();
+      for (vpn = 0; vpn < numPages; vpn++) {
+         entry = &pageTable[vpn];
+         if (!entry->valid || entry->shared) continue;
+         if (entry->readOnly && !entry->cow) continue;
+
+         frame = entry->physicalPage;
+         if (frameInTable[frame]) continue;	// another mapping of a frame
+						// we already know about
+
+         h = HashFrame(frame);
+         b = h % MERGE_HASH_BUCKETS;
+         for (other = bucketHead[b]; other != -1; other = bucketNext[other]) {
+            if ((frameHash[other] == h) &&
+                !memcmp(&machine->mainMemory[other * PageSize],
+                        &machine->mainMemory[frame * PageSize], PageSize))
+               break;
+         }
+
+         if (other == -1) {
+            frameInTable[frame] = TRUE;
+            frameHash[frame] = h;
+            frameOwner[frame] = entry;
+            bucketNext[frame] = bucketHead[b];
+            bucketHead[b] = frame;
+            continue;
+         }
+
+         // Found a twin.  The frame in the table becomes copy-on-write
+         // the first time somebody is merged into it.
+         if (frameCowCount[other] == 0) {
+            frameOwner[other]->readOnly = TRUE;
+            frameOwner[other]->cow = TRUE;
+            frameCowCount[other] = 1;
+         }
+         ReleaseUserFrame(entry);
+         entry->physicalPage = other;
+         entry->readOnly = TRUE;
+         entry->cow = TRUE;
+         frameCowCount[other]++;
+         stats->numPagesMerged++;
+         DEBUG('a', "Merged vpn %d of pid %d, frame %d -> %d\n", vpn, pid,
+               frame, other);
+      }
+   }
+   (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// PageMergeDaemon
+// 	Body of the merging thread.  Sleep for "interval" ticks, then
+//	scan.  Once every other thread has exited there is nothing left
+//	to merge, so halt the machine just like the last Exit would.
+//----------------------------------------------------------------------
+
+static void
+PageMergeDaemon(int interval)
+{
+   for (;;) {
+      currentThread->SortedInsertInWaitQueue(stats->totalTicks + interval);
+
+      if (processTable->NumLive() == 0) {
+         printf("\nNo threads ready or runnable, and no pending interrupts.\n");
+         printf("Assuming all programs completed.\n");
+         interrupt->Halt();
+      }
+
+      MergeIdenticalFrames();
+   }
+}
+
+//----------------------------------------------------------------------
+// StartPageMergeDaemon
+// 	Create the merging thread.  It runs at the lowest priority and
+//	is not counted as a live thread by SC_Exit.
+//----------------------------------------------------------------------
+
+void
+StartPageMergeDaemon(int interval)
+{
+   Thread *daemonThread = new Thread("page merge daemon", MAX_NICE_PRIORITY);
+
+   ASSERT(interval > 0);
+   daemonThread->SetDaemon();
+   daemonThread->UseSmallStack();	// never runs user code
+   daemonThread->Fork(PageMergeDaemon, interval);
+}
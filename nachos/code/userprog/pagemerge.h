@@ -0,0 +1,33 @@
+// pagemerge.h
+//	Routines for merging byte-identical physical frames of user
+//	programs.
+//
+//	A kernel thread wakes up every few timer ticks, hashes the
+//	private frames of all live address spaces and folds frames with
+//	equal contents into a single frame.  Every page table entry that
+//	maps a merged frame is marked read-only and copy-on-write; the
+//	first write through such an entry raises a ReadOnlyException and
+//	gets a private copy back (see BreakCopyOnWrite).
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PAGEMERGE_H
+#define PAGEMERGE_H
+
+#include "copyright.h"
+#include "translate.h"
+
+#define MERGE_HASH_BUCKETS	256		// Buckets in the content hash table
+#define DEFAULT_MERGE_INTERVAL	(10 * TimerTicks)	// Ticks between two scans
+
+extern void StartPageMergeDaemon(int interval);	// Fork the merging thread
+extern void MergeIdenticalFrames();		// One scan over all address spaces
+extern void BreakCopyOnWrite(TranslationEntry *entry);	// Called on a write
+							// to a merged page
+extern void ReleaseUserFrame(TranslationEntry *entry);	// Drop one mapping of
+							// a frame, free it if
+							// it was the last one
+
+#endif // PAGEMERGE_H
@@ -0,0 +1,124 @@
+// pipe.cc
+//	Routines for anonymous pipes.  See pipe.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "pipe.h"
+
+//----------------------------------------------------------------------
+// Pipe::Pipe
+// 	Initialize an empty pipe, with one reference to each end.
+//----------------------------------------------------------------------
+
+Pipe::Pipe()
+{
+    lock = new Lock("pipe lock");
+    notEmpty = new Condition("pipe not empty");
+    notFull = new Condition("pipe not full");
+    head = count = 0;
+    readers = writers = 1;
+    waitingWriters = 0;
+}
+
+//----------------------------------------------------------------------
+// Pipe::~Pipe
+// 	De-allocate a pipe, once both ends are closed.
+//----------------------------------------------------------------------
+
+Pipe::~Pipe()
+{
+    ASSERT((readers == 0) && (writers == 0));
+    delete notFull;
+    delete notEmpty;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// Pipe::Read
+// 	Take up to "size" bytes out of the pipe, waiting (if "wait") until
+//	there is at least one or no writer is left.  Wakes the writers
+//	blocked on a full pipe once half of it is free.  Returns the
+//	number of bytes read, 0 at end of file.
+//----------------------------------------------------------------------
+
+int
+Pipe::Read(char *into, int size, bool wait)
+{
+    int done = 0, span;
+
+    lock->Acquire();
+    while (wait && (count == 0) && (writers > 0)) notEmpty->Wait(lock);
+    while ((done < size) && (count > 0)) {
+	span = PIPE_SIZE - head;		// up to the end of the ring
+	if (span > count) span = count;
+	if (span > size - done) span = size - done;
+	bcopy(&buffer[head], &into[done], span);
+	head = (head + span) % PIPE_SIZE;
+	count -= span;
+	done += span;
+    }
+    if ((waitingWriters > 0) && (PIPE_SIZE - count >= PIPE_SIZE / 2))
+	notFull->Broadcast(lock);
+    lock->Release();
+    return done;
+}
+
+//----------------------------------------------------------------------
+// Pipe::Write
+// 	Put all of "from" into the pipe, waiting for room as needed.
+//	Readers are woken when the pipe fills up and once at the end,
+//	rather than for every byte.  Returns the number of bytes
+//	written, which is less than "size" only if every read end was
+//	closed.
+//----------------------------------------------------------------------
+
+int
+Pipe::Write(char *from, int size)
+{
+    int done = 0, tail, span;
+
+    lock->Acquire();
+    while ((done < size) && (readers > 0)) {
+	if (count == PIPE_SIZE) {
+	    notEmpty->Broadcast(lock);		// let them drain it
+	    waitingWriters++;
+	    notFull->Wait(lock);
+	    waitingWriters--;
+	    continue;
+	}
+	tail = (head + count) % PIPE_SIZE;
+	span = (tail >= head) ? (PIPE_SIZE - tail) : (head - tail);
+	if (span > PIPE_SIZE - count) span = PIPE_SIZE - count;
+	if (span > size - done) span = size - done;
+	bcopy(&from[done], &buffer[tail], span);
+	count += span;
+	done += span;
+    }
+    if (done > 0) notEmpty->Broadcast(lock);
+    lock->Release();
+    return done;
+}
+
+//----------------------------------------------------------------------
+// Pipe::CloseEnd
+// 	Called when the last id referring to an end is closed.  Wakes
+//	up everybody, so that readers see end of file and writers give
+//	up.  Returns TRUE when the pipe can be deleted.
+//----------------------------------------------------------------------
+
+bool
+Pipe::CloseEnd(bool writeEnd)
+{
+    lock->Acquire();
+    if (writeEnd) writers--;
+    else readers--;
+    ASSERT((readers >= 0) && (writers >= 0));
+    notEmpty->Broadcast(lock);
+    notFull->Broadcast(lock);
+    lock->Release();
+    return ((readers == 0) && (writers == 0));
+}
@@ -0,0 +1,48 @@
+// pipe.h
+//	Data structures for anonymous pipes between user processes.
+//
+//	A pipe is a ring buffer of PIPE_SIZE bytes with a read end and a
+//	write end.  Each end is one SharedFile (see fdtable.h), which
+//	any number of ids in any number of processes may refer to.  Readers wait while the pipe is empty and
+//	get end of file once no write end is left; writers wait while it
+//	is full and stop short once no read end is left.
+//
+//	Wakeups are batched.  A writer wakes the readers once per Write,
+//	or when it has filled the buffer, not for every byte; a reader
+//	only wakes waiting writers once at least half the buffer is free.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PIPE_H
+#define PIPE_H
+
+#include "copyright.h"
+#include "synch.h"
+
+#define PIPE_SIZE	512		// Bytes buffered in a pipe
+
+class Pipe {
+  public:
+    Pipe();				// One read end and one write end open
+    ~Pipe();
+
+    int Read(char *into, int size, bool wait);	// Up to "size" bytes; 0 at
+					// end of file, or if "wait" is FALSE
+					// and the pipe is empty
+    int Write(char *from, int size);	// All of "from", unless the read
+					// ends go away first
+
+    bool CloseEnd(bool writeEnd);	// TRUE once both ends are closed
+
+  private:
+    Lock *lock;				// Protects everything below
+    Condition *notEmpty, *notFull;
+    char buffer[PIPE_SIZE];
+    int head, count;			// Oldest byte, bytes buffered
+    int readers, writers;		// Open read and write ends
+    int waitingWriters;			// Writers blocked on a full pipe
+};
+
+#endif // PIPE_H
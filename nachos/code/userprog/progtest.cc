@@ -22,6 +22,51 @@ BatchStartFunction (int dummy)
    machine->Run();
 }
 
+//----------------------------------------------------------------------
+// SpawnProcess
+// 	Create a thread running a fresh copy of the program "filename",
+//	with "argc" arguments "argv", and put it on the ready queue.  It
+//	gets "files" as its open file table.  Used for the jobs of a
+//	batch and by sys_Spawn; no memory is copied from the caller.
+//	Returns NULL, and deletes "files", if the program cannot be
+//	loaded or the arguments do not fit on its stack.
+//
+//	The registers of the new thread are set up in the machine, so a
+//	user program calling this has its own saved and restored around.
+//----------------------------------------------------------------------
+
+Thread *
+SpawnProcess(char *filename, int nice, int argc, char **argv, OpenFileTable *files)
+{
+    ExecImage *image = LoadExecImage(filename);
+    AddrSpace *space;
+    Thread *child;
+
+    if (image == NULL) {
+        delete files;
+        return NULL;
+    }
+    space = new AddrSpace(image);
+    if (currentThread->space != NULL) currentThread->SaveUserState();
+    space->InitRegisters();
+    if (!space->PushArguments(argc, argv)) {
+        if (currentThread->space != NULL) currentThread->RestoreUserState();
+        space->ReleaseMemory();
+        delete space;
+        delete files;
+        return NULL;
+    }
+
+    child = new Thread(filename, nice);
+    child->space = space;
+    child->openFiles = files;
+    child->SaveUserState();
+    if (currentThread->space != NULL) currentThread->RestoreUserState();
+    child->StackAllocate(BatchStartFunction, 0);
+    child->Schedule();
+    return child;
+}
+
 //----------------------------------------------------------------------
 // StartProcess
 // 	Run a user program.  Open the executable, load it into
@@ -31,26 +76,24 @@ BatchStartFunction (int dummy)
 void
 StartProcess(char *filename)
 {
-    
-    currentFile = new char[1024];
-    sprintf(currentFile,"%s",filename);
-
-    OpenFile *executable = fileSystem->Open(filename);
+    ExecImage *image = LoadExecImage(filename);
     AddrSpace *space;
     
 
-    if (executable == NULL) {
+    if (image == NULL) {
     	printf("Unable to open file %s\n", filename);
     	return;
     }
-    space = new AddrSpace(executable);                         
+    space = new AddrSpace(image);                         
  
     currentThread->space = space;
-
-    // delete executable;			// close file                              //akg:: This closes the file, so no more data can be copied. Hence I removed it.
-
+    currentThread->openFiles = new OpenFileTable;
 
     space->InitRegisters();		// set the initial register values
+    if (!space->PushArguments(1, &filename)) {	// argv[0] is the name
+    	printf("Program name %s is too long\n", filename);
+    	return;
+    }
     space->RestoreState();		// load page table register
 
     machine->Run();			// jump to the user progam
@@ -109,7 +152,7 @@ void
 ReadInputAndFork (char *filename)
 {
    OpenFile *inFile = fileSystem->Open(filename);
-   char c, buffer[16];
+   char c;
    unsigned batchSize=0, bytesRead, charPointer, i;
  
    excludeMainThread = TRUE;
@@ -160,31 +203,19 @@ ReadInputAndFork (char *filename)
    delete inFile;
 
    for (i=0; i<batchSize; i++) {
-      // Create one child per iteration
-      inFile = fileSystem->Open(batchProcesses[i]);
-      if (inFile == NULL) {
+      // Create one child per iteration; identical jobs share one image
+      if (SpawnProcess(batchProcesses[i], priority[i], 1, &batchProcesses[i],
+                       new OpenFileTable) == NULL) {
          printf("Unable to open file %s\n", batchProcesses[i]);
          return;
       }
-      sprintf(buffer,"Thread_%d",i+1);
-      Thread *child = new Thread(buffer, priority[i]);
-      child->space = new AddrSpace (inFile);
-      delete inFile;
-      child->space->InitRegisters();             // set the initial register values
-      child->SaveUserState ();
-      child->StackAllocate (BatchStartFunction, 0);
-      child->Schedule ();
-      //printf("Created %d\n", i);
    }
 
    // Cleanly exit current thread
    // Assume exit code zero
    printf("[pid %d]: Exit called. Code: %d\n", currentThread->GetPID(), 0);
-   exitThreadArray[currentThread->GetPID()] = true;
+   processTable->SetExited(currentThread->GetPID());
 
-   // Find out if all threads have called exit
-   for (i=0; i<thread_index; i++) {
-       if (!exitThreadArray[i]) break;
-   }
-   currentThread->Exit(i==thread_index, 0);
+   // Were we the last thread that had not called exit?
+   currentThread->Exit(processTable->NumLive() == 0, 0);
 }
@@ -0,0 +1,52 @@
+#ifndef RING_H
+#define RING_H
+
+// Layout of the shared region set up by sys_RingSetup.  Everything is
+// an int; offsets are in words from the start of the region.
+//
+//	header		RING_HEADER_WORDS words
+//	submissions	"entries" slots of RING_SQE_WORDS words
+//	completions	"entries" slots of RING_CQE_WORDS words
+//	data		the rest, for the buffers of Read and Write
+//
+// The four indices are free-running counters; slot i is entry
+// i % entries.  The program owns RING_SQ_TAIL and RING_CQ_HEAD, the
+// kernel owns RING_SQ_HEAD and RING_CQ_TAIL.
+
+#define RING_SQ_HEAD		0	// Next submission the kernel takes
+#define RING_SQ_TAIL		1	// Next free submission slot
+#define RING_CQ_HEAD		2	// Next completion the program reads
+#define RING_CQ_TAIL		3	// Next completion the kernel posts
+#define RING_ENTRIES		4	// Slots in each ring
+#define RING_HEADER_WORDS	8
+
+// A submission
+#define RING_SQE_OP		0	// RING_OP_*
+#define RING_SQE_ARG		1	// File id, semaphore id or ticks
+#define RING_SQE_BUFFER		2	// Read/Write: address in the data area
+#define RING_SQE_COUNT		3	// Read/Write: bytes; SemOp: -1 or 1
+#define RING_SQE_USER_DATA	4	// Copied to the completion
+#define RING_SQE_WORDS		5
+
+// A completion
+#define RING_CQE_USER_DATA	0
+#define RING_CQE_RESULT		1	// As the synchronous call would return
+#define RING_CQE_WORDS		2
+
+#define RING_OP_NOP		0
+#define RING_OP_READ		1
+#define RING_OP_WRITE		2
+#define RING_OP_SLEEP		3
+#define RING_OP_SEMOP		4
+
+#define RING_MAX_ENTRIES	64
+
+#define RING_SQE(ring, i)	((ring) + RING_HEADER_WORDS + \
+				 ((i) % (ring)[RING_ENTRIES]) * RING_SQE_WORDS)
+#define RING_CQE(ring, i)	((ring) + RING_HEADER_WORDS + \
+				 (ring)[RING_ENTRIES] * RING_SQE_WORDS + \
+				 ((i) % (ring)[RING_ENTRIES]) * RING_CQE_WORDS)
+#define RING_DATA(ring)		((char *)((ring) + RING_HEADER_WORDS + \
+				 (ring)[RING_ENTRIES] * (RING_SQE_WORDS + RING_CQE_WORDS)))
+
+#endif
@@ -0,0 +1,114 @@
+// semset.cc
+//	Routines for System V style semaphore sets.  See semset.h.
+//
+//	As for Semaphore, atomicity comes from disabling interrupts.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "semset.h"
+
+//----------------------------------------------------------------------
+// SemaphoreSet::SemaphoreSet
+// 	Create "size" semaphores with value zero.
+//----------------------------------------------------------------------
+
+SemaphoreSet::SemaphoreSet(int numSems)
+{
+    int i;
+
+    size = numSems;
+    values = new int[size];
+    for (i = 0; i < size; i++) values[i] = 0;
+    waiters = new ThreadQueue;
+}
+
+SemaphoreSet::~SemaphoreSet()
+{
+    delete [] values;
+    delete waiters;
+}
+
+//----------------------------------------------------------------------
+// SemaphoreSet::TryOperate
+// 	Check that every operation of "ops" can go ahead; if so, apply
+//	them all and return TRUE.  The same semaphore may appear more
+//	than once, so the checks are done on a scratch copy of the
+//	values touched.  Semaphore numbers were checked by the caller.
+//----------------------------------------------------------------------
+
+bool
+SemaphoreSet::TryOperate(SemBuf *ops, int numOps)
+{
+    int i, j, value;
+
+    for (i = 0; i < numOps; i++) {
+	value = values[ops[i].num];
+	for (j = 0; j < i; j++)			// earlier ops on the same one
+	    if (ops[j].num == ops[i].num) value += ops[j].adjustment;
+	if ((ops[i].adjustment == 0) && (value != 0)) return FALSE;
+	if (value + ops[i].adjustment < 0) return FALSE;
+    }
+    for (i = 0; i < numOps; i++) values[ops[i].num] += ops[i].adjustment;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// SemaphoreSet::WakeAll
+// 	Make every sleeper try again.  Interrupts are off.
+//----------------------------------------------------------------------
+
+void
+SemaphoreSet::WakeAll()
+{
+    Thread *thread;
+
+    while ((thread = waiters->Remove()) != NULL)
+	scheduler->ReadyToRun(thread);
+}
+
+//----------------------------------------------------------------------
+// SemaphoreSet::Operate
+// 	Apply "ops" as one atomic step.  If they cannot all be applied,
+//	either give up ("noWait") or sleep until some value changes and
+//	try again.
+//----------------------------------------------------------------------
+
+bool
+SemaphoreSet::Operate(SemBuf *ops, int numOps, bool noWait)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    bool changed = FALSE;
+    int i;
+
+    while (!TryOperate(ops, numOps)) {
+	if (noWait) {
+	    (void) interrupt->SetLevel(oldLevel);
+	    return FALSE;
+	}
+	waiters->Append(currentThread);
+	currentThread->Sleep();
+    }
+    for (i = 0; i < numOps; i++)
+	if (ops[i].adjustment != 0) changed = TRUE;
+    if (changed) WakeAll();
+    (void) interrupt->SetLevel(oldLevel);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// SemaphoreSet::SetValue
+//----------------------------------------------------------------------
+
+void
+SemaphoreSet::SetValue(int which, int value)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    values[which] = value;
+    WakeAll();
+    (void) interrupt->SetLevel(oldLevel);
+}
@@ -0,0 +1,51 @@
+// semset.h
+//	Data structures for System V style semaphore sets.
+//
+//	A set holds a number of counting semaphores that are operated on
+//	together: one SemOpMulti call gives a list of (semaphore,
+//	adjustment) pairs, and they are applied all at once or not at
+//	all.  A negative adjustment needs the value to be at least its
+//	size, a zero adjustment needs the value to be zero; if any of
+//	them cannot be satisfied, the caller sleeps (or fails, with
+//	SEM_NOWAIT) without having changed anything.
+//
+//	Whoever changes a value wakes every sleeper of the set, and each
+//	of them tries its whole list again.  This is simple, and fair
+//	enough for the small sets user programs build.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SEMSET_H
+#define SEMSET_H
+
+#include "copyright.h"
+#include "threadqueue.h"
+#include "syscall.h"
+
+class SemaphoreSet {
+  public:
+    SemaphoreSet(int size);		// "size" semaphores, all zero
+    ~SemaphoreSet();			// Assumes nobody is waiting
+
+    int GetSize() { return size; }
+    bool IsBusy() { return !waiters->IsEmpty(); }	// Somebody sleeps in Operate
+    int GetValue(int which) { return values[which]; }
+    void SetValue(int which, int value);	// Wakes up the sleepers
+
+    bool Operate(SemBuf *ops, int numOps, bool noWait);
+					// Apply "ops" atomically, sleeping
+					// until they can be; FALSE if they
+					// cannot be right now and "noWait"
+
+  private:
+    bool TryOperate(SemBuf *ops, int numOps);	// Apply if possible
+    void WakeAll();
+
+    int size;
+    int *values;
+    ThreadQueue *waiters;		// Threads sleeping in Operate
+};
+
+#endif // SEMSET_H
@@ -0,0 +1,366 @@
+// swap.cc
+//	Routines for page replacement and for the swap tiers that hold
+//	evicted pages: the compressed pool and the backing store.
+//
+//	The frame table (frameSpace, frameVpn, ...) tells us which page
+//	of which address space sits in each physical frame.  Frames
+//	without an owner -- shared memory, merged copy-on-write frames,
+//	frames being filled -- are never chosen as victims.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "swap.h"
+
+static int pendingSwapTicks = 0;	// Transfer time owed by the faulting thread
+static int clockHand = 0;		// Next frame looked at by CLOCK_REPLACEMENT
+
+//----------------------------------------------------------------------
+// CompressedPool::CompressedPool
+// 	Initialize an empty pool that may hold "capacity" bytes of
+//	compressed pages.
+//----------------------------------------------------------------------
+
+CompressedPool::CompressedPool(int cap, int size)
+{
+    int i;
+
+    capacity = cap;
+    pageSize = size;
+    used = 0;
+    scratch = new char[2 * pageSize + 2];	// room for the worst case
+
+    numSlots = 64;
+    slotData = new char*[numSlots];
+    slotSize = new int[numSlots];
+    for (i = 0; i < numSlots; i++) slotData[i] = NULL;
+
+    numStores = numRejects = numLoads = 0;
+}
+
+//----------------------------------------------------------------------
+// CompressedPool::~CompressedPool
+// 	Free all compressed pages.
+//----------------------------------------------------------------------
+
+CompressedPool::~CompressedPool()
+{
+    int i;
+
+    for (i = 0; i < numSlots; i++)
+	if (slotData[i] != NULL) delete [] slotData[i];
+    delete [] slotData;
+    delete [] slotSize;
+    delete [] scratch;
+}
+
+//----------------------------------------------------------------------
+// CompressedPool::Compress
+// 	PackBits encoding of one page.  A header byte h >= 0 is followed
+//	by h+1 literal bytes; a header h < 0 is followed by one byte to
+//	be repeated 1-h times.  Returns the encoded length; gives up as
+//	soon as the output is larger than the page.
+//----------------------------------------------------------------------
+
+int
+CompressedPool::Compress(char *page, char *into)
+{
+    int i = 0, n = 0, run, lit;
+
+    while ((i < pageSize) && (n <= pageSize)) {
+	run = 1;
+	while ((i + run < pageSize) && (run < 128) && (page[i + run] == page[i]))
+	    run++;
+	if (run >= 2) {
+	    into[n++] = (char)(1 - run);
+	    into[n++] = page[i];
+	    i += run;
+	}
+	else {
+	    lit = 0;
+	    while ((i + lit < pageSize) && (lit < 128) &&
+		   !((i + lit + 1 < pageSize) && (page[i + lit] == page[i + lit + 1])))
+		lit++;
+	    into[n++] = (char)(lit - 1);
+	    bcopy(&page[i], &into[n], lit);
+	    n += lit;
+	    i += lit;
+	}
+    }
+    return n;
+}
+
+//----------------------------------------------------------------------
+// CompressedPool::Store
+// 	Compress "page" into a free slot.  Pages that do not shrink by at
+//	least a quarter are not worth keeping here, and neither are pages
+//	that would push the pool over its capacity; for both we return -1
+//	and the caller sends the page to backing store.
+//----------------------------------------------------------------------
+
+int
+CompressedPool::Store(char *page)
+{
+    int size = Compress(page, scratch);
+    int slot, i;
+
+    if ((size > pageSize - pageSize/4) || (used + size > capacity)) {
+	numRejects++;
+	return -1;
+    }
+
+    for (slot = 0; slot < numSlots; slot++)
+	if (slotData[slot] == NULL) break;
+    if (slot == numSlots) {			// grow the slot table
+	char **newData = new char*[2 * numSlots];
+	int *newSize = new int[2 * numSlots];
+	for (i = 0; i < numSlots; i++) {
+	    newData[i] = slotData[i];
+	    newSize[i] = slotSize[i];
+	}
+	for (; i < 2 * numSlots; i++) newData[i] = NULL;
+	delete [] slotData;
+	delete [] slotSize;
+	slotData = newData;
+	slotSize = newSize;
+	numSlots *= 2;
+    }
+
+    slotData[slot] = new char[size];
+    bcopy(scratch, slotData[slot], size);
+    slotSize[slot] = size;
+    used += size;
+    numStores++;
+    return slot;
+}
+
+//----------------------------------------------------------------------
+// CompressedPool::Load
+// 	Decompress "slot" into "page".  The slot stays allocated.
+//----------------------------------------------------------------------
+
+void
+CompressedPool::Load(int slot, char *page)
+{
+    char *data;
+    int i = 0, out = 0, count;
+    signed char h;
+
+    ASSERT((slot >= 0) && (slot < numSlots) && (slotData[slot] != NULL));
+    data = slotData[slot];
+    while (i < slotSize[slot]) {
+	h = (signed char)data[i++];
+	if (h >= 0) {
+	    count = h + 1;
+	    ASSERT(out + count <= pageSize);
+	    bcopy(&data[i], &page[out], count);
+	    i += count;
+	}
+	else {
+	    count = 1 - h;
+	    ASSERT(out + count <= pageSize);
+	    memset(&page[out], data[i++], count);
+	}
+	out += count;
+    }
+    ASSERT(out == pageSize);
+    numLoads++;
+}
+
+//----------------------------------------------------------------------
+// CompressedPool::Duplicate
+// 	Make a second copy of "slot" for a forked child.
+//----------------------------------------------------------------------
+
+int
+CompressedPool::Duplicate(int slot)
+{
+    char *page = new char[pageSize];
+    int copy;
+
+    Load(slot, page);
+    numLoads--;				// not a page-in
+    copy = Store(page);
+    delete [] page;
+    return copy;
+}
+
+//----------------------------------------------------------------------
+// CompressedPool::Free
+// 	Give back the space used by "slot".
+//----------------------------------------------------------------------
+
+void
+CompressedPool::Free(int slot)
+{
+    ASSERT((slot >= 0) && (slot < numSlots) && (slotData[slot] != NULL));
+    used -= slotSize[slot];
+    delete [] slotData[slot];
+    slotData[slot] = NULL;
+}
+
+//----------------------------------------------------------------------
+// CompressedPool::Print
+// 	Print pool usage, when the machine halts.
+//----------------------------------------------------------------------
+
+void
+CompressedPool::Print()
+{
+    printf("Compressed pool: capacity %d bytes, used %d, stores %d, rejected %d, loads %d\n",
+	capacity, used, numStores, numRejects, numLoads);
+}
+
+//----------------------------------------------------------------------
+// AddSwapLatency, WaitForSwapIO
+// 	Swap transfers are done immediately, but the thread that caused
+//	them has to wait for their simulated duration before it returns
+//	to user mode.  WaitForSwapIO is called at the end of the page
+//	fault (and fork, ShmAllocate, copy-on-write) handlers.
+//----------------------------------------------------------------------
+
+void
+AddSwapLatency(int ticks)
+{
+    pendingSwapTicks += ticks;
+}
+
+void
+WaitForSwapIO()
+{
+    int ticks = pendingSwapTicks;
+
+    pendingSwapTicks = 0;
+    if (ticks > 0)
+	currentThread->SortedInsertInWaitQueue(stats->totalTicks + ticks);
+}
+
+//----------------------------------------------------------------------
+// IsEvictable
+// 	A frame may be replaced if it holds a private, valid page of
+//	some address space that is not shared with anybody.  If "owner"
+//	is not NULL, only frames of that address space qualify.
+//----------------------------------------------------------------------
+
+static bool
+IsEvictable(int frame, AddrSpace *owner)
+{
+    TranslationEntry *entry;
+
+    if (!PhyPageIsAllocated[frame] || (frameSpace[frame] == NULL)) return FALSE;
+    if ((owner != NULL) && (frameSpace[frame] != owner)) return FALSE;
+    if (frameCowCount[frame] > 0) return FALSE;
+    entry = &frameSpace[frame]->GetPageTable()[frameVpn[frame]];
+    return (entry->valid && !entry->shared && (entry->physicalPage == frame));
+}
+
+//----------------------------------------------------------------------
+// ChooseVictim
+// 	Pick a frame to replace according to replacementAlgo, among all
+//	frames (global replacement) or among the frames of "owner"
+//	(local replacement).  Returns -1 if no frame can be replaced,
+//	or if replacement is off.
+//----------------------------------------------------------------------
+
+static int
+ChooseVictim(AddrSpace *owner)
+{
+    int victim = -1, frame, start, i;
+    TranslationEntry *entry;
+
+    switch (replacementAlgo) {
+      case RANDOM_REPLACEMENT:
+	start = Random() % NumPhysPages;
+	for (i = 0; i < NumPhysPages; i++) {
+	    frame = (start + i) % NumPhysPages;
+	    if (IsEvictable(frame, owner)) { victim = frame; break; }
+	}
+	break;
+
+      case FIFO_REPLACEMENT:
+	for (frame = 0; frame < NumPhysPages; frame++) {
+	    if (IsEvictable(frame, owner) && ((victim == -1) ||
+			(frameLoadTime[frame] < frameLoadTime[victim])))
+		victim = frame;
+	}
+	break;
+
+      case LRU_REPLACEMENT:
+	for (frame = 0; frame < NumPhysPages; frame++) {
+	    if (IsEvictable(frame, owner) && ((victim == -1) ||
+			(frameLastUse[frame] < frameLastUse[victim])))
+		victim = frame;
+	}
+	break;
+
+      case CLOCK_REPLACEMENT:
+	for (i = 0; i < 2 * NumPhysPages; i++) {	// second lap finds a
+	    frame = clockHand;				// cleared use bit
+	    clockHand = (clockHand + 1) % NumPhysPages;
+	    if (!IsEvictable(frame, owner)) continue;
+	    entry = &frameSpace[frame]->GetPageTable()[frameVpn[frame]];
+	    if (entry->use) entry->use = FALSE;
+	    else { victim = frame; break; }
+	}
+	break;
+
+      default:				// no replacement (-R not given)
+	break;
+    }
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// EvictFrame
+// 	Save the page held by "victim" and free the frame.
+//----------------------------------------------------------------------
+
+static void
+EvictFrame(int victim)
+{
+    DEBUG('a', "Replacing frame %d (vpn %d)\n", victim, frameVpn[victim]);
+    frameSpace[victim]->PageOut(frameVpn[victim]);
+    frameSpace[victim] = NULL;
+    PhyPageIsAllocated[victim] = FALSE;
+    numPagesAllocated--;
+}
+
+//----------------------------------------------------------------------
+// PageReplacement
+// 	Called by FindFreeFrame when all frames are allocated.  Replace
+//	a page of any address space and return the now unallocated frame.
+//----------------------------------------------------------------------
+
+int
+PageReplacement()
+{
+    int victim = ChooseVictim(NULL);
+
+    if (victim == -1) {
+	printf("Out of memory: no page can be replaced.\n");
+	ASSERT(FALSE);
+    }
+    EvictFrame(victim);
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// ReplaceLocalPage
+// 	Called when "space" is at its resident-set limit: replace one of
+//	its own pages, so that it does not take frames from anybody else.
+//	Returns FALSE if none of its pages can be replaced (e.g. they are
+//	all merged), in which case the limit is not enforced this time.
+//----------------------------------------------------------------------
+
+bool
+ReplaceLocalPage(AddrSpace *space)
+{
+    int victim = ChooseVictim(space);
+
+    if (victim == -1) return FALSE;
+    EvictFrame(victim);
+    return TRUE;
+}
@@ -0,0 +1,84 @@
+// swap.h
+//	Data structures for the swap tiers behind demand paging.
+//
+//	A page chosen by page replacement is saved in one of two places:
+//
+//	   the compressed pool -- a budget of host memory, sized as a
+//		fraction of physical memory, holding run-length encoded
+//		copies of evicted pages.  Cheap to store to and load from.
+//	   the backing store -- one page-sized slot per virtual page of
+//		the address space.  Every transfer counts as a disk
+//		request and costs a seek plus a rotation.
+//
+//	Pages go to the pool first; pages that do not compress well, or
+//	that do not fit in what is left of the pool, go to backing store.
+//	Clean pages that still match the executable are simply dropped.
+//
+//	The faulting thread is put to sleep for the simulated cost of
+//	the transfers done on its behalf (see WaitForSwapIO).
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SWAP_H
+#define SWAP_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "stats.h"
+
+class AddrSpace;
+
+// Where an evicted page lives.  Non-negative values are pool slots.
+#define SWAP_NONE		-1	// not swapped; load from the executable
+#define SWAP_ON_DISK		-2	// in the backing store
+
+#define SWAP_DISK_TICKS		(SeekTime + RotationTime)	// one page to/from disk
+#define POOL_STORE_TICKS	(2 * SystemTick)	// compress one page
+#define POOL_LOAD_TICKS		SystemTick		// decompress one page
+
+#define MAX_POOL_PERCENT	90	// at most this much of NumPhysPages
+
+// The following class defines the compressed page pool.  Pages are
+// encoded with a PackBits style run-length code, which is very good at
+// the zero-filled and repetitive pages user programs leave behind.
+
+class CompressedPool {
+  public:
+    CompressedPool(int capacity, int pageSize);	// "capacity" is in bytes
+    ~CompressedPool();
+
+    int Store(char *page);		// Compress a page into the pool;
+					// return the slot, or -1 if the page
+					// compresses badly or does not fit
+    void Load(int slot, char *page);	// Decompress slot into "page"
+    int Duplicate(int slot);		// Copy a slot (used by fork); -1
+					// if there is no room
+    void Free(int slot);		// Release a slot
+
+    void Print();			// Print pool usage at halt
+
+  private:
+    int Compress(char *page, char *into);	// Returns the encoded size
+
+    int capacity;			// Budget in bytes
+    int used;				// Bytes of compressed data held
+    int pageSize;
+    char *scratch;			// Compression buffer
+
+    int numSlots;			// Size of the slot table
+    char **slotData;			// Encoded page, NULL for a free slot
+    int *slotSize;			// Encoded length
+
+    int numStores, numRejects, numLoads;	// Usage counters
+};
+
+extern void AddSwapLatency(int ticks);	// Charge a transfer to the faulting
+					// thread
+extern void WaitForSwapIO();		// Sleep for the charged transfers
+
+extern bool ReplaceLocalPage(AddrSpace *space);	// Evict one page of "space";
+						// FALSE if none can go
+
+#endif // SWAP_H
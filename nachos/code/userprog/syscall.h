@@ -49,7 +49,44 @@
 #define syscall_CondOp		25
 #define syscall_CondRemove	26
 #define syscall_ShmAllocate	27
+#define syscall_MemStat		28
+#define syscall_SetMemLimit	29
+#define syscall_RingSetup	30
+#define syscall_RingEnter	31
+#define syscall_Batch		32
+#define syscall_Spawn		33
+#define syscall_FutexWait	34
+#define syscall_FutexWake	35
+#define syscall_SetAtomicRegion	36
+#define syscall_SemSetGet	37
+#define syscall_SemOpMulti	38
+#define syscall_SemSetCtl	39
+#define syscall_RWLockGet	40
+#define syscall_RWLockOp	41
+#define syscall_RWLockRemove	42
+#define syscall_BarrierGet	43
+#define syscall_BarrierWait	44
+#define syscall_BarrierRemove	45
+#define syscall_MsgQueueGet	46
+#define syscall_MsgSend		47
+#define syscall_MsgReceive	48
+#define syscall_MsgQueueRemove	49
 #define syscall_NumInstr        50
+#define syscall_Pipe		51
+#define syscall_Dup2		52
+#define syscall_PageSize	53
+
+#define MAX_SYSCALL_CODE	63	/* Largest code the kernel can handle */
+
+#define BATCH_RECORD_WORDS	6	/* Size of a BatchRecord, see sys_Batch */
+#define MAX_BATCH_RECORDS	64	/* Most calls in one sys_Batch */
+
+#define MAX_SEMSET_SIZE		64	/* Semaphores in one set */
+#define MAX_SEMSET_OPS		32	/* Operations in one sys_SemOpMulti */
+#define SEM_NOWAIT		1	/* Flag: fail instead of sleeping */
+
+#define MAX_MSG_QUEUE_LENGTH	64	/* Messages one queue can hold */
+#define MAX_MSG_SIZE		4096	/* Bytes in one message */
 
 #ifndef IN_ASM
 
@@ -76,14 +113,28 @@ void sys_Exit(int status);
 /* This is same as PID. */
 typedef int SpaceId;	
  
-/* Run the executable, stored in the Nachos file "name". Doesn't return.
+/* Run the executable, stored in the Nachos file "name", in place of the
+ * calling program, passing it the NULL terminated vector "argv" (NULL
+ * passes just the name; see sys_Spawn).  The pid, children and open
+ * files are kept.  Doesn't return, unless the program cannot be started,
+ * in which case it returns -1.
  */
-void sys_Exec(char *name);
+int sys_Exec(char *name, char **argv);
  
 /* Only return once the the user program "id" has finished.  
  * Return the exit status.
  */
 int sys_Join(SpaceId id); 	
+
+/* Run the executable "name" in a new child process, passing it the
+ * NULL terminated vector "argv" as main's (argc, argv); a NULL "argv"
+ * passes just the name.  Unlike sys_Fork followed by sys_Exec, nothing
+ * of the caller's memory is copied.  The child shares the caller's
+ * ConsoleInput and ConsoleOutput, which may be redirected with
+ * sys_Dup2, but no other open file.  Returns the pid of the child, or
+ * -1 if it cannot be started.
+ */
+SpaceId sys_Spawn(char *name, char **argv);
  
 
 /* File system operations: Create, Open, Read, Write, Close
@@ -107,16 +158,20 @@ typedef int OpenFileId;
 #define ConsoleInput	0  
 #define ConsoleOutput	1  
  
-/* Create a Nachos file, with "name" */
-void sys_Create(char *name);
+/* Create a Nachos file, with "name".  Return 0, or -1 on failure. */
+int sys_Create(char *name);
 
 /* Open the Nachos file "name", and return an "OpenFileId" that can 
- * be used to read and write to the file.
+ * be used to read and write to the file, or -1 on failure.  A child
+ * created by Fork inherits the open files of its parent, and shares
+ * their position with it.
  */
 OpenFileId sys_Open(char *name);
 
-/* Write "size" bytes from "buffer" to the open file. */
-void sys_Write(char *buffer, int size, OpenFileId id);
+/* Write "size" bytes from "buffer" to the open file.  Return the number
+ * of bytes written, or -1 on failure.
+ */
+int sys_Write(char *buffer, int size, OpenFileId id);
 
 /* Read "size" bytes from the open file into "buffer".  
  * Return the number of bytes actually read -- if the open file isn't
@@ -126,8 +181,25 @@ void sys_Write(char *buffer, int size, OpenFileId id);
  */
 int sys_Read(char *buffer, int size, OpenFileId id);
 
-/* Close the file, we're done reading and writing to it. */
-void sys_Close(OpenFileId id);
+/* Create a pipe: ids[0] is its read end, ids[1] its write end.  Reads
+ * wait for at least one byte and return 0 once every write end is
+ * closed; writes wait for room and return -1 once every read end is
+ * closed.  Both ends are inherited by Fork; Spawn only passes on what
+ * was put at ConsoleInput and ConsoleOutput.  Returns 0, or -1 if
+ * there are not two free ids.
+ */
+int sys_Pipe(OpenFileId *ids);
+
+/* Make "newId" refer to the file or pipe end open at "oldId", closing
+ * it first if needed.  Used to redirect ConsoleInput and ConsoleOutput
+ * (sys_Close on them goes back to the console).  Returns newId, or -1.
+ */
+int sys_Dup2(OpenFileId oldId, OpenFileId newId);
+
+/* Close the file, we're done reading and writing to it.  Return 0, or
+ * -1 if "id" is not open.
+ */
+int sys_Close(OpenFileId id);
 
 
 
@@ -172,14 +244,174 @@ void sys_SemOp (int semid, int adjust);
 
 int sys_SemCtl (int semid, unsigned command, int *val);
 
+/* Semaphore sets.  sys_SemSetGet returns the id of the set of "size"
+ * semaphores with "key", creating it (all values zero) if needed, or
+ * -1.  sys_SemSetCtl takes SYNCH_GET, SYNCH_SET (value of semaphore
+ * "num" from/to *val) or SYNCH_REMOVE, and returns 0 or -1.
+ * SYNCH_REMOVE fails while anybody is waiting in sys_SemOpMulti.
+ */
+int sys_SemSetGet (int key, int size);
+int sys_SemSetCtl (int setid, unsigned command, int num, int *val);
+
+/* One operation of sys_SemOpMulti: add "adjustment" to semaphore "num"
+ * of the set.  A negative adjustment waits until the value is large
+ * enough, zero waits until the value is zero.
+ */
+typedef struct {
+   int num;
+   int adjustment;
+} SemBuf;
+
+/* Apply the "count" operations in "ops" to the set, all at once: the
+ * caller sleeps until every one of them can go ahead, and none is
+ * applied before that.  With SEM_NOWAIT in "flags", returns -1 instead
+ * of sleeping.  Returns 0 once done, -1 on a bad set, number or count.
+ */
+int sys_SemOpMulti (int setid, SemBuf *ops, int count, int flags);
+
 int sys_CondGet (int key);
 
 void sys_CondOp (int condid, unsigned op, int semid);
 
 int sys_CondRemove (int condid);
 
+/* Reader-writer locks.  sys_RWLockGet returns the id of the lock with
+ * "key", creating it if needed, or -1.  sys_RWLockOp takes
+ * RWLOCK_OP_READ, RWLOCK_OP_WRITE or RWLOCK_OP_UNLOCK; all waiting
+ * readers are let in together.  Returns 0, or -1 on a bad id or op,
+ * when unlocking a lock the caller does not hold, or when a reader
+ * asks to write.  sys_RWLockRemove fails while the lock is held or
+ * waited for.
+ */
+int sys_RWLockGet (int key);
+int sys_RWLockOp (int rwid, unsigned op);
+int sys_RWLockRemove (int rwid);
+
+/* Barriers.  sys_BarrierGet returns the id of the barrier for "count"
+ * processes with "key", creating it if needed, or -1 (also if it
+ * exists with another count).  sys_BarrierWait blocks until "count"
+ * processes are waiting, then releases them all; it returns 1 in the
+ * last one to arrive, 0 in the others, -1 on a bad id.
+ * sys_BarrierRemove fails while anybody is waiting.
+ */
+int sys_BarrierGet (int key, int count);
+int sys_BarrierWait (int barrierid);
+int sys_BarrierRemove (int barrierid);
+
+/* Message queues.  sys_MsgQueueGet returns the id of the queue with
+ * "key", creating it with room for "capacity" messages if needed, or
+ * -1.  sys_MsgSend queues "size" bytes at "buf", waiting while the
+ * queue is full, and returns 0 or -1.  sys_MsgReceive waits for the
+ * oldest message and stores it at "buf"; it returns the size of the
+ * message, or -1 if that is larger than "size" (the message then stays
+ * queued).  A message of whole pages sent from and received at
+ * page-aligned addresses is moved by remapping the pages copy-on-write,
+ * without copying.  sys_MsgQueueRemove drops any queued messages, and
+ * fails while somebody is waiting on the queue.
+ */
+int sys_MsgQueueGet (int key, int capacity);
+int sys_MsgSend (int queueid, char *buf, int size);
+int sys_MsgReceive (int queueid, char *buf, int size);
+int sys_MsgQueueRemove (int queueid);
+
+/* Bytes per page, which is chosen when Nachos starts (-ps) */
+int sys_PageSize (void);
+
 unsigned sys_ShmAllocate (unsigned size);
 
+/* Fill in NUM_MEM_STATS memory counters of the caller, see memstat.h.
+ * Returns -1 if "counters" is not a valid address.
+ */
+int sys_MemStat (int *counters);
+
+/* Keep at most "pages" private pages of the caller in memory (0: no
+ * limit).  Returns -1 if page replacement is off (no -R).
+ */
+int sys_SetMemLimit (int pages);
+
+/* Map a ring for asynchronous calls with "entries" submission and
+ * completion slots and "dataSize" bytes for Read/Write buffers, and
+ * return its address (-1 on failure).  See ring.h for the layout.
+ * A process has at most one ring; it is not inherited by Fork, whose
+ * child gets a private copy of the region instead.
+ */
+int *sys_RingSetup (int entries, int dataSize);
+
+/* Tell the kernel about new submissions, and wait until at least
+ * "minComplete" completions are unread (or nothing is left to do).
+ * Returns the number of unread completions, -1 if there is no ring.
+ */
+int sys_RingEnter (int minComplete);
+
+/* One call of a batch: the syscall_* code, up to four arguments, and
+ * the value the call returned, filled in by the kernel.
+ */
+typedef struct {
+   int code;
+   int args[4];
+   int result;
+} BatchRecord;
+
+/* Make the "count" calls in "records" in one trap, in order.  Stops
+ * at the first call that fails (negative result), that could block
+ * (a P on a semaphore at zero, a Write to anything but the console,
+ * printing more than the kernel's console buffer has room for), or
+ * that may not be batched (Exit, Exec, Fork, Join, Create, Open, Read,
+ * Close, Sleep, Yield, CondOp, ...).  Returns the number of calls that
+ * completed; if that is less than "count", records[n] is where it
+ * stopped.
+ */
+int sys_Batch (BatchRecord *records, int count);
+
+/* Queued versions of the print calls, see start.s.  Nothing is
+ * printed until batch_Flush (or Fork, Exit, or Halt) sends the queue
+ * to the kernel in one sys_Batch, or the queue fills up.  A string
+ * passed to batch_PrintString must not change until then.  Flush
+ * before mixing in calls that are not queued.
+ */
+void batch_PrintInt (int x);
+void batch_PrintChar (char x);
+void batch_PrintIntHex (int x);
+void batch_PrintString (char *x);
+int batch_Flush (void);
+
+/* Sleep until woken by sys_FutexWake on "addr", provided *addr still
+ * equals "expected" when the kernel looks.  Returns 0 once woken, -1
+ * at once if *addr has changed (or is not a valid aligned word).
+ * Meant for words in memory from sys_ShmAllocate.
+ */
+int sys_FutexWait (int *addr, int expected);
+
+/* Wake at most "count" threads sleeping on "addr".  Returns how many
+ * were woken.
+ */
+int sys_FutexWake (int *addr, int count);
+
+/* Declare [start, end) the restartable atomic sequence of this
+ * program: a thread switched out inside it resumes at "start".
+ * Returns 0, or -1 for a bad range.  Used by atomic_Setup.
+ */
+int sys_SetAtomicRegion (void *start, void *end);
+
+/* User-level atomic operation, see start.s.  atomic_Setup must have
+ * been called once (test/usync.c does it).  atomic_CompareSwap stores
+ * "newValue" in *addr if *addr equals "old"; either way it returns what
+ * *addr held.
+ */
+int atomic_Setup (void);
+int atomic_CompareSwap (int *addr, int old, int newValue);
+
+/* Load linked and store conditional, see start.s.  A store
+ * conditional to the word of the last load linked succeeds (returns 1)
+ * only if nothing was stored near the word and no other thread ran in
+ * between; otherwise it stores nothing and returns 0.  atomic_FetchAdd
+ * and atomic_Swap are built on them and return the previous value.
+ */
+int atomic_LoadLinked (int *addr);
+int atomic_StoreConditional (int *addr, int value);
+int atomic_FetchAdd (int *addr, int delta);
+int atomic_Swap (int *addr, int value);
+
 int sys_GetNumInstr (void);
 #endif /* IN_ASM */
 
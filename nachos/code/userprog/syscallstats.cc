@@ -0,0 +1,260 @@
+// syscallstats.cc
+//	Routines to count, time and trace system calls.  See
+//	syscallstats.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "syscallstats.h"
+
+//----------------------------------------------------------------------
+// LatencyBucket
+// 	Histogram bucket of a latency: 0 for 0, b for [2^(b-1), 2^b).
+//	The last bucket takes everything larger.
+//----------------------------------------------------------------------
+
+static int
+LatencyBucket(unsigned latency)
+{
+    int b = 0;
+
+    while ((latency > 0) && (b < NUM_LATENCY_BUCKETS - 1)) {
+	latency >>= 1;
+	b++;
+    }
+    return b;
+}
+
+//----------------------------------------------------------------------
+// SyscallStats::SyscallStats
+// 	Initialize the counters of call numbers 0 to "maxCode".
+//----------------------------------------------------------------------
+
+SyscallStats::SyscallStats(int maxCode)
+{
+    int i, b;
+
+    numCodes = maxCode + 1;
+    count = new int[numCodes];
+    finished = new int[numCodes];
+    totalTicks = new int[numCodes];
+    totalHostMicros = new double[numCodes];
+    tickHistogram = new int*[numCodes];
+    hostHistogram = new int*[numCodes];
+    for (i = 0; i < numCodes; i++) {
+	count[i] = finished[i] = totalTicks[i] = 0;
+	totalHostMicros[i] = 0;
+	tickHistogram[i] = new int[NUM_LATENCY_BUCKETS];
+	hostHistogram[i] = new int[NUM_LATENCY_BUCKETS];
+	for (b = 0; b < NUM_LATENCY_BUCKETS; b++)
+	    tickHistogram[i][b] = hostHistogram[i][b] = 0;
+    }
+
+    numPids = 0;
+    pidCount = pidTicks = NULL;			// sized on the first call
+
+    traceFile = -1;
+    traceBuffer = NULL;
+    traceUsed = 0;
+}
+
+//----------------------------------------------------------------------
+// SyscallStats::~SyscallStats
+//----------------------------------------------------------------------
+
+SyscallStats::~SyscallStats()
+{
+    int i;
+
+    if (traceFile != -1) {
+	FlushTrace();
+	Close(traceFile);
+	delete [] traceBuffer;
+    }
+    for (i = 0; i < numCodes; i++) {
+	delete [] tickHistogram[i];
+	delete [] hostHistogram[i];
+    }
+    for (i = 0; i < numPids; i++) {
+	if (pidCount[i] != NULL) delete [] pidCount[i];
+	if (pidTicks[i] != NULL) delete [] pidTicks[i];
+    }
+    delete [] count;
+    delete [] finished;
+    delete [] totalTicks;
+    delete [] totalHostMicros;
+    delete [] tickHistogram;
+    delete [] hostHistogram;
+    delete [] pidCount;
+    delete [] pidTicks;
+}
+
+//----------------------------------------------------------------------
+// SyscallStats::StartTrace
+// 	Write a record of every call from now on to the UNIX file
+//	"fileName".
+//----------------------------------------------------------------------
+
+void
+SyscallStats::StartTrace(char *fileName)
+{
+    ASSERT(traceFile == -1);
+    traceFile = OpenForWrite(fileName);
+    traceBuffer = new int[TRACE_BUFFER_RECORDS * TRACE_RECORD_WORDS];
+    traceUsed = 0;
+}
+
+//----------------------------------------------------------------------
+// SyscallStats::Trace, FlushTrace
+// 	Buffer one trace record; write the buffer out when it is full.
+//----------------------------------------------------------------------
+
+void
+SyscallStats::Trace(int kind, int pid, int code, int a, int b, int c, int d)
+{
+    int *record;
+
+    if (traceFile == -1) return;
+    record = &traceBuffer[traceUsed * TRACE_RECORD_WORDS];
+    record[0] = kind;
+    record[1] = pid;
+    record[2] = code;
+    record[3] = stats->totalTicks;
+    record[4] = a;
+    record[5] = b;
+    record[6] = c;
+    record[7] = d;
+    if (++traceUsed == TRACE_BUFFER_RECORDS) FlushTrace();
+}
+
+void
+SyscallStats::FlushTrace()
+{
+    if (traceUsed > 0)
+	WriteFile(traceFile, (char *)traceBuffer,
+		  traceUsed * TRACE_RECORD_WORDS * sizeof(int));
+    traceUsed = 0;
+}
+
+//----------------------------------------------------------------------
+// SyscallStats::CallStarted
+// 	Process "pid" made call "code" with arguments "args[0..3]".
+//----------------------------------------------------------------------
+
+void
+SyscallStats::CallStarted(int pid, int code, int *args)
+{
+    int i;
+
+    ASSERT((code >= 0) && (code < numCodes));
+    ASSERT(pid >= 0);
+    if (pid >= numPids) GrowPids(pid);
+    count[code]++;
+    if (pidCount[pid] == NULL) {
+	pidCount[pid] = new int[numCodes];
+	pidTicks[pid] = new int[numCodes];
+	for (i = 0; i < numCodes; i++) pidCount[pid][i] = pidTicks[pid][i] = 0;
+    }
+    pidCount[pid][code]++;
+    Trace(TRACE_CALL, pid, code, args[0], args[1], args[2], args[3]);
+}
+
+//----------------------------------------------------------------------
+// SyscallStats::GrowPids
+// 	Make room for the counters of "pid", as many slots as the
+//	process table has.
+//----------------------------------------------------------------------
+
+void
+SyscallStats::GrowPids(int pid)
+{
+    int newSize = processTable->NumSlots();
+    int **newCount, **newTicks;
+    int i;
+
+    ASSERT(pid < newSize);
+    newCount = new int*[newSize];
+    newTicks = new int*[newSize];
+    for (i = 0; i < newSize; i++) {
+	newCount[i] = (i < numPids) ? pidCount[i] : NULL;
+	newTicks[i] = (i < numPids) ? pidTicks[i] : NULL;
+    }
+    if (pidCount != NULL) {
+	delete [] pidCount;
+	delete [] pidTicks;
+    }
+    pidCount = newCount;
+    pidTicks = newTicks;
+    numPids = newSize;
+}
+
+//----------------------------------------------------------------------
+// SyscallStats::CallFinished
+// 	The call returned "result", "ticks" simulated ticks and
+//	"hostMicros" host microseconds after it was made.
+//----------------------------------------------------------------------
+
+void
+SyscallStats::CallFinished(int pid, int code, int result, int ticks,
+			   unsigned hostMicros)
+{
+    finished[code]++;
+    totalTicks[code] += ticks;
+    totalHostMicros[code] += hostMicros;
+    tickHistogram[code][LatencyBucket(ticks)]++;
+    hostHistogram[code][LatencyBucket(hostMicros)]++;
+    pidTicks[pid][code] += ticks;
+    Trace(TRACE_RETURN, pid, code, result, ticks, (int)hostMicros, 0);
+}
+
+//----------------------------------------------------------------------
+// SyscallStats::Print
+// 	Print one line per call number that was used, with its latency
+//	histograms, then the calls made by each process.  A histogram
+//	entry "<2^b:n" means n calls took less than 2^b ticks (or
+//	microseconds) but at least 2^(b-1).
+//----------------------------------------------------------------------
+
+void
+SyscallStats::Print()
+{
+    int code, pid, b;
+    char *name;
+
+    printf("System calls:\n");
+    printf("%-12s %8s %8s %10s %10s %12s\n", "call", "count", "returned",
+	   "ticks", "avg ticks", "avg host us");
+    for (code = 0; code < numCodes; code++) {
+	if (count[code] == 0) continue;
+	name = SyscallName(code);
+	printf("%-12s %8d %8d %10d %10.1f %12.1f\n", (name != NULL) ? name : "?",
+	       count[code], finished[code], totalTicks[code],
+	       finished[code] ? (double)totalTicks[code] / finished[code] : 0.0,
+	       finished[code] ? totalHostMicros[code] / finished[code] : 0.0);
+	if (finished[code] == 0) continue;
+	printf("    ticks:");
+	for (b = 0; b < NUM_LATENCY_BUCKETS; b++)
+	    if (tickHistogram[code][b] > 0)
+		printf(" <2^%d:%d", b, tickHistogram[code][b]);
+	printf("\n    host us:");
+	for (b = 0; b < NUM_LATENCY_BUCKETS; b++)
+	    if (hostHistogram[code][b] > 0)
+		printf(" <2^%d:%d", b, hostHistogram[code][b]);
+	printf("\n");
+    }
+
+    for (pid = 0; pid < numPids; pid++) {
+	if (pidCount[pid] == NULL) continue;
+	printf("[pid %d]", pid);
+	for (code = 0; code < numCodes; code++) {
+	    if (pidCount[pid][code] == 0) continue;
+	    name = SyscallName(code);
+	    printf(" %s %d (%d ticks)", (name != NULL) ? name : "?",
+		   pidCount[pid][code], pidTicks[pid][code]);
+	}
+	printf("\n");
+    }
+}
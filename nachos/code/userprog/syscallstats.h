@@ -0,0 +1,76 @@
+// syscallstats.h
+//	Data structures for measuring system calls.
+//
+//	When enabled (-ss or -st), the syscall dispatcher tells a
+//	SyscallStats about every call a user program makes.  For each
+//	call number we keep a count, the total latency in simulated ticks
+//	and in host microseconds, and log2 histograms of both; for each
+//	process, a count and total ticks per call number.  Halt prints the
+//	lot.  Latency includes any time the caller spends blocked.
+//
+//	With -st, every call is also written to a binary trace file as
+//	two records of TRACE_RECORD_WORDS host-order ints: one when the
+//	call is made, one when it returns.  Calls that never return
+//	(Exit, Exec, Halt) only have the first.
+//
+//	   TRACE_CALL:   kind, pid, code, ticks, arg1, arg2, arg3, arg4
+//	   TRACE_RETURN: kind, pid, code, ticks, result, latency in ticks,
+//			 latency in host microseconds, 0
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SYSCALLSTATS_H
+#define SYSCALLSTATS_H
+
+#include "copyright.h"
+#include "utility.h"
+
+#define NUM_LATENCY_BUCKETS	24	// Bucket b counts latencies below 2^b
+
+#define TRACE_CALL		0
+#define TRACE_RETURN		1
+#define TRACE_RECORD_WORDS	8
+#define TRACE_BUFFER_RECORDS	256	// Records written to the file at once
+
+class SyscallStats {
+  public:
+    SyscallStats(int maxCode);		// Codes 0..maxCode
+    ~SyscallStats();			// Flushes and closes the trace
+
+    void StartTrace(char *fileName);	// Also write a binary trace
+
+    void CallStarted(int pid, int code, int *args);	// Called before the
+    void CallFinished(int pid, int code, int result,	// handler, and after
+		      int ticks, unsigned hostMicros);	// it if it returns
+
+    void Print();			// Summary table, at halt
+
+  private:
+    void Trace(int kind, int pid, int code, int a, int b, int c, int d);
+    void GrowPids(int pid);		// Make room for "pid"
+    void FlushTrace();
+
+    int numCodes;
+    int *count;				// Calls made
+    int *finished;			// Calls that returned
+    int *totalTicks;
+    double *totalHostMicros;
+    int **tickHistogram;		// [code][bucket]
+    int **hostHistogram;
+
+    int **pidCount;			// [pid][code], NULL for processes
+    int **pidTicks;			// that made no calls; a recycled
+					// pid adds up all its processes
+    int numPids;			// Size of pidCount and pidTicks
+
+    int traceFile;			// -1 if not tracing
+    int *traceBuffer;
+    int traceUsed;			// Records in traceBuffer
+};
+
+extern char *SyscallName(int code);	// From the syscall table (exception.cc);
+					// NULL for an unused code
+
+#endif // SYSCALLSTATS_H